@@ -0,0 +1,137 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace banjo
+{
+
+namespace
+{
+
+// Allocate a chunk capable of holding n bytes following its header.
+template<typename C>
+inline C*
+new_chunk(std::size_t n)
+{
+  void* p = ::operator new(sizeof(C) + n);
+  C* c = static_cast<C*>(p);
+  c->next = nullptr;
+  c->size = n;
+  return c;
+}
+
+
+// Release a list of chunks.
+template<typename C>
+inline void
+free_chunks(C* c)
+{
+  while (c) {
+    C* n = c->next;
+    ::operator delete(c);
+    c = n;
+  }
+}
+
+
+} // namespace
+
+
+constexpr std::size_t Arena::granularity;
+constexpr std::size_t Arena::max_small_size;
+constexpr std::size_t Arena::num_classes;
+constexpr std::size_t Arena::min_slab_size;
+constexpr std::size_t Arena::max_slab_size;
+
+
+Arena::Arena()
+  : cur(nullptr), end(nullptr), next(min_slab_size)
+  , slabs(nullptr), large(nullptr), cleanups(nullptr), free()
+  , reserved(0), allocated(0)
+{ }
+
+
+Arena::~Arena()
+{
+  release();
+}
+
+
+// Destroy all managed objects in the reverse order of their creation,
+// and then release all memory.
+void
+Arena::release()
+{
+  // Note that cleanup records are themselves stored in the arena,
+  // so the memory cannot be released until all have been run.
+  for (Cleanup* c = cleanups; c; c = c->next)
+    c->fn(c->obj);
+  cleanups = nullptr;
+
+  free_chunks(slabs);
+  free_chunks(large);
+  slabs = large = nullptr;
+  cur = end = nullptr;
+  next = min_slab_size;
+  std::fill(free, free + num_classes, nullptr);
+  reserved = allocated = 0;
+}
+
+
+// Allocate storage when the current slab is exhausted. Objects that
+// would consume a significant fraction of a slab are given their own
+// chunk so that the remainder of the current slab is not wasted.
+void*
+Arena::allocate_slow(std::size_t n, std::size_t a)
+{
+  if (n + a > next / 4)
+    return allocate_large(n, a);
+  add_slab(next);
+  return allocate(n, a);
+}
+
+
+// Allocate a dedicated chunk for a large object.
+void*
+Arena::allocate_large(std::size_t n, std::size_t a)
+{
+  Chunk* c = new_chunk<Chunk>(n + a);
+  c->next = large;
+  large = c;
+  reserved += sizeof(Chunk) + n + a;
+  allocated += n;
+  char* p = reinterpret_cast<char*>(c + 1);
+  return reinterpret_cast<char*>(round(reinterpret_cast<std::size_t>(p), a));
+}
+
+
+// Add a new slab of n bytes and make it the current slab. The size
+// of subsequent slabs grows geometrically.
+void
+Arena::add_slab(std::size_t n)
+{
+  Chunk* c = new_chunk<Chunk>(n);
+  c->next = slabs;
+  slabs = c;
+  reserved += sizeof(Chunk) + n;
+  cur = reinterpret_cast<char*>(c + 1);
+  end = cur + n;
+  next = std::min(2 * next, max_slab_size);
+}
+
+
+// Register a destructor to be run when the arena is released.
+void
+Arena::add_cleanup(void (*fn)(void*), void* obj)
+{
+  void* p = allocate(sizeof(Cleanup), alignof(Cleanup));
+  cleanups = new (p) Cleanup{cleanups, fn, obj};
+}
+
+
+} // namespace banjo
@@ -0,0 +1,191 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_ARENA_HPP
+#define BANJO_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace banjo
+{
+
+// Determines if objects of type T must be destroyed when the arena is
+// released. By default, this is true when T has a non-trivial destructor.
+//
+// A polymorphic class never has a trivial destructor, even when that
+// destructor does nothing else. Such classes can specialize this trait
+// (as false) when destroying them has no effect, so that they are not
+// registered for cleanup.
+template<typename T>
+struct Needs_cleanup
+  : std::integral_constant<bool, !std::is_trivially_destructible<T>::value>
+{ };
+
+
+// An arena allocator provides fast, region-based allocation for
+// objects whose lifetime is bound to the lifetime of the arena (e.g.,
+// the terms of a translation unit).
+//
+// Small objects are bump-allocated from a sequence of geometrically
+// growing slabs. Large objects are allocated in dedicated chunks. All
+// memory is released at once when the arena is destroyed.
+//
+// Blocks returned by deallocate() are kept in size-segregated free
+// lists and reused by subsequent allocations of the same size class.
+// This supports short-lived objects (e.g., block scopes) whose storage
+// is released before the arena.
+//
+// Objects created with make() are destroyed, in reverse order of their
+// construction, when the arena is released. Objects that need no
+// destruction (see Needs_cleanup) incur no cleanup overhead.
+struct Arena
+{
+  // Allocations are rounded up to this granularity.
+  static constexpr std::size_t granularity = 16;
+
+  // The largest allocation managed by the size-class free lists.
+  static constexpr std::size_t max_small_size = 256;
+
+  // The number of size classes.
+  static constexpr std::size_t num_classes = max_small_size / granularity;
+
+  // The size of the first slab. Subsequent slabs double in size up to
+  // the maximum slab size.
+  static constexpr std::size_t min_slab_size = 16 * 1024;
+  static constexpr std::size_t max_slab_size = 1024 * 1024;
+
+  Arena();
+  ~Arena();
+
+  // Non-copyable
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  // Raw allocation
+  void* allocate(std::size_t, std::size_t = alignof(std::max_align_t));
+  void  deallocate(void*, std::size_t);
+
+  // Object allocation
+  template<typename T, typename... Args>
+  T& make(Args&&...);
+
+  // Release all memory and destroy all objects.
+  void release();
+
+  // Statistics
+  std::size_t bytes_reserved() const { return reserved; }
+  std::size_t bytes_allocated() const { return allocated; }
+
+private:
+  // A memory chunk. The chunk header is followed by its storage.
+  struct Chunk
+  {
+    Chunk*      next;
+    std::size_t size;
+  };
+
+  // A cleanup action for a non-trivially destructible object.
+  struct Cleanup
+  {
+    Cleanup* next;
+    void   (*fn)(void*);
+    void*    obj;
+  };
+
+  // A block in a free list.
+  struct Free_block
+  {
+    Free_block* next;
+  };
+
+  template<typename T>
+  static void destroy(void* p) { static_cast<T*>(p)->~T(); }
+
+  static std::size_t round(std::size_t, std::size_t);
+
+  void* allocate_slow(std::size_t, std::size_t);
+  void* allocate_large(std::size_t, std::size_t);
+  void  add_slab(std::size_t);
+  void  add_cleanup(void (*)(void*), void*);
+
+  char*       cur;       // The next available byte in the current slab
+  char*       end;       // The end of the current slab
+  std::size_t next;      // The size of the next slab
+  Chunk*      slabs;     // Allocated slabs
+  Chunk*      large;     // Dedicated chunks for large objects
+  Cleanup*    cleanups;  // Pending destructor calls
+  Free_block* free[num_classes];
+
+  std::size_t reserved;  // Total bytes obtained from the system
+  std::size_t allocated; // Total bytes handed out
+};
+
+
+// Round n up to the next multiple of a, which must be a power of 2.
+inline std::size_t
+Arena::round(std::size_t n, std::size_t a)
+{
+  return (n + a - 1) & ~(a - 1);
+}
+
+
+// Allocate n bytes of storage aligned to a. Small allocations first
+// try to reuse a previously deallocated block of the same size class
+// before bumping the current slab.
+inline void*
+Arena::allocate(std::size_t n, std::size_t a)
+{
+  n = round(n ? n : 1, granularity);
+  if (a <= granularity && n <= max_small_size) {
+    if (Free_block* b = free[n / granularity - 1]) {
+      free[n / granularity - 1] = b->next;
+      return b;
+    }
+  }
+  char* p = reinterpret_cast<char*>(round(reinterpret_cast<std::size_t>(cur), a));
+  if (p <= end && n <= std::size_t(end - p)) {
+    cur = p + n;
+    allocated += n;
+    return p;
+  }
+  return allocate_slow(n, a);
+}
+
+
+// Return n bytes of storage at p to the arena. Storage for small
+// objects is recycled; larger blocks are reclaimed when the arena
+// is released.
+inline void
+Arena::deallocate(void* p, std::size_t n)
+{
+  n = round(n ? n : 1, granularity);
+  if (n <= max_small_size) {
+    Free_block* b = static_cast<Free_block*>(p);
+    b->next = free[n / granularity - 1];
+    free[n / granularity - 1] = b;
+  }
+}
+
+
+// Allocate and construct an object of type T. If T needs cleanup, the
+// object is destroyed when the arena is released.
+template<typename T, typename... Args>
+inline T&
+Arena::make(Args&&... args)
+{
+  void* p = allocate(sizeof(T), alignof(T));
+  T* t = new (p) T(std::forward<Args>(args)...);
+  if (Needs_cleanup<T>::value)
+    add_cleanup(&destroy<T>, t);
+  return *t;
+}
+
+
+} // namespace banjo
+
+
+#endif
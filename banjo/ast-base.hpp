@@ -8,11 +8,16 @@
 // supporting structures.
 
 #include "prelude.hpp"
+#include "token-buffer.hpp"
 
 #include <lingo/integer.hpp>
 #include <lingo/real.hpp>
 #include <lingo/token.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 #include <utility>
 
@@ -24,20 +29,25 @@ struct Term;
 
 struct Name;
 struct Type;
+struct Unary_type;
 struct Expr;
 struct Id_expr;
 struct Decl_expr;
 struct Unary_expr;
 struct Binary_expr;
 struct Dot_expr;
+struct Nested_decl_expr;
 struct Conv;
+struct Standard_conv;
 struct Init;
 struct Req;
 struct Stmt;
+struct Multiple_stmt;
 struct Decl;
 struct Object_decl;
 struct Def;
 struct Cons;
+struct Binary_cons;
 
 
 #define define_node(Node) struct Node;
@@ -59,6 +69,30 @@ struct Overload_set;
 using lingo::Integer;
 
 
+// -------------------------------------------------------------------------- //
+// Term kinds
+
+// The kind of a term. There is one kind for each node listed in the
+// .def files. The order of kinds follows the .def files so that the
+// kinds of nodes derived from a common base form a contiguous range.
+//
+// Terms that are not nodes (e.g., lists) have no kind.
+enum Term_kind : std::uint16_t
+{
+  no_kind,
+#define define_node(Node) Node##_kind,
+#include "ast-name.def"
+#include "ast-type.def"
+#include "ast-expr.def"
+#include "ast-req.def"
+#include "ast-stmt.def"
+#include "ast-decl.def"
+#include "ast-def.def"
+#include "ast-cons.def"
+#undef define_node
+};
+
+
 // -------------------------------------------------------------------------- //
 // Terms
 
@@ -67,10 +101,37 @@ using lingo::Integer;
 // Each term has an associated source code location. However, this
 // is not meaningful for all terms. In particular, canonicalized
 // terms must not include a valid source code location.
+//
+// Each node also records its kind, which is set when the node is
+// created by a builder or factory (see init_kind). Nodes created by
+// other means have no kind, and are classified using RTTI.
+//
+// The structural hash of a term is computed on demand and cached in
+// the term (see ast-hash.hpp). A term must not be modified in a way
+// that affects its hash once that hash has been computed. Because
+// terms are shared with worker contexts, the cached value is atomic;
+// racing workers compute and store the same value.
 struct Term
 {
+  Term() = default;
+
+  Term(Term const& t)
+    : loc(t.loc), tag(t.tag), hc(t.hc.load(std::memory_order_relaxed))
+  { }
+
+  Term& operator=(Term const& t)
+  {
+    loc = t.loc;
+    tag = t.tag;
+    hc.store(t.hc.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+  }
+
   virtual ~Term() { }
 
+  // Returns the kind of the term.
+  Term_kind term_kind() const { return tag; }
+
   // Returns the source code location of the term. this
   // may be an invalid position.
   Location location() const { return loc; }
@@ -80,10 +141,254 @@ struct Term
   // and ends at the term's location.
   virtual Region region() const { return {loc, loc}; }
 
-  Location loc;
+  Location  loc;
+  Term_kind tag = no_kind;
+
+  // The cached hash value, or 0 if it has not been computed.
+  mutable std::atomic<std::size_t> hc {0};
+};
+
+
+// -------------------------------------------------------------------------- //
+// Classification
+//
+// These functions hide lingo's is, as, and cast for terms. When a term
+// has a kind, classification is a range check on that kind. Otherwise,
+// these fall back to dynamic_cast.
+
+// The kind of the node T, or no_kind if T is not a node.
+template<typename T>
+struct Kind_of
+{
+  static constexpr Term_kind value = no_kind;
 };
 
 
+#define define_node(Node) \
+template<> \
+struct Kind_of<Node> \
+{ \
+  static constexpr Term_kind value = Node##_kind; \
+};
+#include "ast-name.def"
+#include "ast-type.def"
+#include "ast-expr.def"
+#include "ast-req.def"
+#include "ast-stmt.def"
+#include "ast-decl.def"
+#include "ast-def.def"
+#include "ast-cons.def"
+#undef define_node
+
+
+// The range of kinds [first, last] of the nodes derived from T
+// (including T). By default, this is just the kind of T.
+template<typename T>
+struct Kind_range
+{
+  static constexpr Term_kind first = Kind_of<T>::value;
+  static constexpr Term_kind last = Kind_of<T>::value;
+};
+
+
+#define define_range(T, First, Last) \
+template<> \
+struct Kind_range<T> \
+{ \
+  static constexpr Term_kind first = First##_kind; \
+  static constexpr Term_kind last = Last##_kind; \
+};
+
+define_range(Name, Simple_id, Qualified_id)
+
+define_range(Type, Void_type, Unparsed_type)
+define_range(User_type, User_type, Synthetic_type)
+define_range(Unary_type, Qualified_type, Pack_type)
+
+define_range(Expr, Boolean_expr, Aggregate_init)
+define_range(Id_expr, Object_expr, Overload_expr)
+define_range(Decl_expr, Object_expr, Function_expr)
+define_range(Dot_expr, Field_expr, Member_expr)
+define_range(Nested_decl_expr, Field_expr, Method_expr)
+define_range(Binary_expr, Add_expr, Assign_expr)
+define_range(Unary_expr, Neg_expr, Not_expr)
+define_range(Conv, Value_conv, Ellipsis_conv)
+define_range(Standard_conv, Value_conv, Numeric_conv)
+define_range(Init, Trivial_init, Aggregate_init)
+
+define_range(Req, Type_req, Deduction_req)
+
+define_range(Stmt, Empty_stmt, Unparsed_stmt)
+define_range(Multiple_stmt, Translation_stmt, Compound_stmt)
+
+define_range(Decl, Super_decl, Template_parm)
+define_range(Object_decl, Super_decl, Value_parm)
+define_range(Variable_decl, Variable_decl, Field_decl)
+define_range(Function_decl, Function_decl, Method_decl)
+
+define_range(Def, Empty_def, Concept_def)
+
+define_range(Cons, Concept_cons, Parameterized_cons)
+define_range(Binary_cons, Conjunction_cons, Disjunction_cons)
+
+#undef define_range
+
+
+// Set the kind of a newly created node.
+template<typename T>
+inline T&
+init_kind(T& t)
+{
+  t.tag = Kind_of<T>::value;
+  return t;
+}
+
+
+// Returns true if the term u is, or is derived from, T.
+template<typename T>
+inline bool
+is_kind(Term const& u)
+{
+  using R = Kind_range<typename std::remove_cv<T>::type>;
+  if (R::first == no_kind || u.tag == no_kind)
+    return dynamic_cast<T const*>(&u);
+  return R::first <= u.tag && u.tag <= R::last;
+}
+
+
+// Convert u to T. When T is derived from U, this is a static
+// conversion. Otherwise, this is a cross-cast.
+template<typename T, typename U>
+inline T*
+term_cast(U* u, std::true_type)
+{
+  return static_cast<T*>(u);
+}
+
+
+template<typename T, typename U>
+inline T*
+term_cast(U* u, std::false_type)
+{
+  return dynamic_cast<T*>(u);
+}
+
+
+template<typename T, typename U>
+inline T*
+term_cast(U* u)
+{
+  return term_cast<T>(u, std::is_base_of<U, T>());
+}
+
+
+// Returns true if a and b are the same kind of term.
+inline bool
+is_same_kind(Term const& a, Term const& b)
+{
+  if (a.tag != no_kind && b.tag != no_kind)
+    return a.tag == b.tag;
+  return typeid(a) == typeid(b);
+}
+
+
+template<typename U>
+using If_term = typename std::enable_if<std::is_base_of<Term, U>::value>::type;
+
+
+// Returns true if u is non-null and points to a T.
+template<typename T, typename U, typename = If_term<U>>
+inline bool
+is(U const* u)
+{
+  return u && is_kind<T>(*u);
+}
+
+
+// Returns true if u is a T.
+template<typename T, typename U, typename = If_term<U>>
+inline bool
+is(U const& u)
+{
+  return is_kind<T>(u);
+}
+
+
+// Returns u as a T, or nullptr if u is not a T.
+template<typename T, typename U, typename = If_term<U>>
+inline T*
+as(U* u)
+{
+  return is<T>(u) ? term_cast<T>(u) : nullptr;
+}
+
+
+template<typename T, typename U, typename = If_term<U>>
+inline T const*
+as(U const* u)
+{
+  return is<T>(u) ? term_cast<T const>(u) : nullptr;
+}
+
+
+// Returns u as a T. Throws std::bad_cast if u is not a T.
+template<typename T, typename U, typename = If_term<U>>
+inline T&
+as(U& u)
+{
+  if (!is<T>(u))
+    throw std::bad_cast();
+  return *term_cast<T>(&u);
+}
+
+
+template<typename T, typename U, typename = If_term<U>>
+inline T const&
+as(U const& u)
+{
+  if (!is<T>(u))
+    throw std::bad_cast();
+  return *term_cast<T const>(&u);
+}
+
+
+// Returns u as a T. Behavior is undefined if u is not a T.
+template<typename T, typename U, typename = If_term<U>>
+inline T&
+cast(U& u)
+{
+  lingo_assert(is<T>(u));
+  return *term_cast<T>(&u);
+}
+
+
+template<typename T, typename U, typename = If_term<U>>
+inline T const&
+cast(U const& u)
+{
+  lingo_assert(is<T>(u));
+  return *term_cast<T const>(&u);
+}
+
+
+template<typename T, typename U, typename = If_term<U>>
+inline T*
+cast(U* u)
+{
+  lingo_assert(!u || is<T>(u));
+  return term_cast<T>(u);
+}
+
+
+template<typename T, typename U, typename = If_term<U>>
+inline T const*
+cast(U const* u)
+{
+  lingo_assert(!u || is<T>(u));
+  return term_cast<T const>(u);
+}
+
+
 // -------------------------------------------------------------------------- //
 // Lists
 
@@ -226,18 +531,18 @@ using Decl_iter = Decl_list::iterator;
 using Cons_iter = Cons_list::iterator;
 
 
-// Unparsed terms.
+// Unparsed terms. The tokens of an unparsed term are a range of the
+// token buffer of the translation.
 template<typename T>
 struct Unparsed_term : T
 {
-  Unparsed_term(Token_seq&& toks)
-    : toks(std::move(toks))
+  Unparsed_term(Token_range toks)
+    : toks(toks)
   { }
 
-  Token_seq const& tokens() const { return toks; }
-  Token_seq&       tokens()       { return toks; }
+  Token_range tokens() const { return toks; }
 
-  Token_seq toks;
+  Token_range toks;
 };
 
 
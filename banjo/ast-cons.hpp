@@ -240,9 +240,17 @@ struct Generic_cons_mutator : Cons::Mutator, Generic_mutator<F, T>
 
 // Apply a function to the given constraint.
 template<typename F, typename T = typename std::result_of<F(Concept_cons const&)>::type>
-inline decltype(auto)
+inline T
 apply(Cons const& c, F fn)
 {
+  switch (c.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(c)));
+#include "ast-cons.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_cons_visitor<F, T> vis(fn);
   return accept(c, vis);
 }
@@ -250,9 +258,17 @@ apply(Cons const& c, F fn)
 
 // Apply a function to the given name.
 template<typename F, typename T = typename std::result_of<F(Concept_cons&)>::type>
-inline decltype(auto)
+inline T
 apply(Cons& c, F fn)
 {
+  switch (c.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(c)));
+#include "ast-cons.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_cons_mutator<F, T> vis(fn);
   return accept(c, vis);
 }
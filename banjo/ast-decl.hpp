@@ -562,9 +562,17 @@ struct Generic_decl_mutator : Decl::Mutator, Generic_mutator<F, T>
 
 // Apply a function to the given declaration.
 template<typename F, typename T = typename std::result_of<F(Variable_decl const&)>::type>
-inline decltype(auto)
+inline T
 apply(Decl const& d, F fn)
 {
+  switch (d.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(d)));
+#include "ast-decl.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_decl_visitor<F, T> vis(fn);
   return accept(d, vis);
 }
@@ -572,9 +580,17 @@ apply(Decl const& d, F fn)
 
 // Apply a function to the given declaration.
 template<typename F, typename T = typename std::result_of<F(Variable_decl&)>::type>
-inline decltype(auto)
+inline T
 apply(Decl& d, F fn)
 {
+  switch (d.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(d)));
+#include "ast-decl.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_decl_mutator<F, T> vis(fn);
   return accept(d, vis);
 }
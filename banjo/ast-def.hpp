@@ -201,18 +201,34 @@ struct Generic_def_mutator : Def::Mutator, Generic_mutator<F, T>
 
 
 template<typename F, typename T = typename std::result_of<F(Empty_def const&)>::type>
-inline decltype(auto)
+inline T
 apply(Def const& t, F fn)
 {
+  switch (t.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(t)));
+#include "ast-def.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_def_visitor<F, T> vis(fn);
   return accept(t, vis);
 }
 
 
 template<typename F, typename T = typename std::result_of<F(Empty_def&)>::type>
-inline decltype(auto)
+inline T
 apply(Def& t, F fn)
 {
+  switch (t.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(t)));
+#include "ast-def.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_def_mutator<F, T> vis(fn);
   return accept(t, vis);
 }
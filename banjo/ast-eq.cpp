@@ -4,484 +4,275 @@
 #include "ast-eq.hpp"
 #include "ast.hpp"
 
-#include <typeindex>
+#include <vector>
 
 
 namespace banjo
 {
 
-
-// Returns true.
-template<typename T>
-bool
-always_equal(T const& t1, T const& t2)
-{
-  return true;
-}
-
-
 // -------------------------------------------------------------------------- //
-// Terms
-
-bool
-is_equivalent(Term const& x1, Term const& x2)
-{
-  // The same objects represent the same types.
-  if (&x1 == &x2)
-    return true;
-
-  // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(x1);
-  std::type_index ti2 = typeid(x2);
-  if (ti1 != ti2)
-    return false;
-
-  if (Type const* t1 = as<Type>(&x1))
-    return is_equivalent(*t1, cast<Type>(x2));
-  if (Expr const* t1 = as<Expr>(&x1))
-    return is_equivalent(*t1, cast<Expr>(x2));
-  if (Decl const* t1 = as<Decl>(&x1))
-    return is_equivalent(*t1, cast<Decl>(x2));
-  banjo_unhandled_case(x1);
-}
-
-
-
-// -------------------------------------------------------------------------- //
-// Names
-
-// Two simple-ids are equal iff they have the same spelling. This is the
-// case when the underlying symbols are the same.
-inline bool
-is_equivalent(Simple_id const& n1, Simple_id const& n2)
-{
-  return &n1.symbol() == &n2.symbol();
-}
-
-
-inline bool
-is_equivalent(Global_id const& n1, Global_id const& n2)
-{
-  lingo_unreachable();
-}
-
-
-inline bool
-is_equivalent(Placeholder_id const& n1, Placeholder_id const& n2)
-{
-  return n1.number() == n2.number();
-}
-
-// they are operator-function-ids formed with the same operator
-inline bool
-is_equivalent(Operator_id const& n1, Operator_id const& n2)
-{
-  return n1.kind() == n2.kind();
-}
-
-
-inline bool
-is_equivalent(Conversion_id const& n1, Conversion_id const& n2)
-{
-  lingo_unreachable();
-}
-
-
-inline bool
-is_equivalent(Literal_id const& n1, Literal_id const& n2)
-{
-  lingo_unreachable();
-}
-
+// Equivalence engine
+//
+// Terms are compared iteratively. Each pair of terms on the work list is
+// first compared by identity, then by cached hash value (when both are
+// available), and then by kind. Terms of the same kind are compared by
+// their values, and pairs of non-identical components are added to the
+// work list. Comparison stops at the first difference.
 
-inline bool
-is_equivalent(Destructor_id const& n1, Destructor_id const& n2)
+namespace
 {
-  lingo_unreachable();
-}
-
 
-inline bool
-is_equivalent(Template_id const& n1, Template_id const& n2)
-{
-  lingo_unreachable();
-}
+using Term_pair = std::pair<Term const*, Term const*>;
+using Work_list = std::vector<Term_pair>;
 
 
-inline bool
-is_equivalent(Concept_id const& n1, Concept_id const& n2)
+// Compares two terms of the same kind, and schedules the comparison
+// of their components. Returns false if the terms are known to differ.
+struct Compare
 {
-  lingo_unreachable();
-}
+  template<typename T>
+  T const& other() const { return cast<T>(y); }
 
-
-inline bool
-is_equivalent(Qualified_id const& n1, Qualified_id const& n2)
-{
-  lingo_unreachable();
-}
-
-
-bool
-is_equivalent(Name const& n1, Name const& n2)
-{
-  struct fn
+  // Schedule the comparison of a and b, unless they are identical.
+  bool push(Term const& a, Term const& b)
   {
-    Name const& n2;
-    bool operator()(Simple_id const& n1)      { return is_equivalent(n1, cast<Simple_id>(n2)); }
-    bool operator()(Global_id const& n1)      { return is_equivalent(n1, cast<Global_id>(n2)); }
-    bool operator()(Placeholder_id const& n1) { return is_equivalent(n1, cast<Placeholder_id>(n2)); }
-    bool operator()(Operator_id const& n1)    { return is_equivalent(n1, cast<Operator_id>(n2)); }
-    bool operator()(Conversion_id const& n1)  { return is_equivalent(n1, cast<Conversion_id>(n2)); }
-    bool operator()(Literal_id const& n1)     { return is_equivalent(n1, cast<Literal_id>(n2)); }
-    bool operator()(Destructor_id const& n1)  { return is_equivalent(n1, cast<Destructor_id>(n2)); }
-    bool operator()(Template_id const& n1)    { return is_equivalent(n1, cast<Template_id>(n2)); }
-    bool operator()(Concept_id const& n1)     { return is_equivalent(n1, cast<Concept_id>(n2)); }
-    bool operator()(Qualified_id const& n1)   { return is_equivalent(n1, cast<Qualified_id>(n2)); }
-  };
-
-  // The same objects represent the same types.
-  if (&n1 == &n2)
+    if (&a != &b)
+      work.emplace_back(&a, &b);
     return true;
+  }
 
-  // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(n1);
-  std::type_index ti2 = typeid(n2);
-  if (ti1 != ti2)
-    return false;
-
-  // Find a comparison of the types.
-  return apply(n1, fn{n2});
-}
-
-
-// -------------------------------------------------------------------------- //
-// Types
-
-
-bool
-is_equivalent(Integer_type const& t1, Integer_type const& t2)
-{
-  return t1.is_signed() == t2.is_signed() && t1.precision() == t2.precision();
-}
-
-
-bool
-is_equivalent(Float_type const& t1, Float_type const& t2)
-{
-  return t1.precision() == t2.precision();
-}
-
-
-// TODO: When are two placeholder types equivalent?
-bool
-is_equivalent(Auto_type const&, Auto_type const&)
-{
-  return false;
-}
-
-
-bool
-is_equivalent(Decltype_type const& a, Decltype_type const& b)
-{
-  lingo_unreachable();
-}
-
-
-// TODO: When are placeholder types equivalent?
-bool
-is_equivalent(Declauto_type const& t1, Declauto_type const& t2)
-{
-  return false;
-}
-
-
-bool
-is_equivalent(Function_type const& t1, Function_type const& t2)
-{
-  return is_equivalent(t1.parameter_types(), t2.parameter_types())
-      && is_equivalent(t1.return_type(), t2.return_type());
-}
-
-
-bool
-is_equivalent(Qualified_type const& t1, Qualified_type const& t2)
-{
-  return t1.qualifier() == t2.qualifier() && is_equivalent(t1.type(), t2.type());
-}
-
-
-bool
-is_equivalent(Unary_type const& t1, Unary_type const& t2)
-{
-  return is_equivalent(t1.type(), t2.type());
-}
-
-
-// TODO: The extent of the arrays must be equivalent.
-bool
-is_equivalent(Array_type const&, Array_type const&)
-{
-  lingo_unreachable();
-}
-
-
-bool
-is_equivalent(Dynarray_type const&, Dynarray_type const&)
-{
-  lingo_unreachable();
-}
-
-
-bool
-is_equivalent(User_type const& t1, User_type const& t2)
-{
-  return is_equivalent(t1.declaration(), t2.declaration());
-}
-
-
-// Two synthetic types are equivalent only when they are identical.
-// Here, t1 and t2 are known not to be identical.
-inline bool
-is_equivalent(Synthetic_type const& t1, Synthetic_type const& t2)
-{
-  return false;
-}
-
-
-// Returns true if the types a and b are equivalent.
-//
-// TODO: Finish implementing this function.
-bool
-is_equivalent(Type const& t1, Type const& t2)
-{
-  struct fn
+  // Schedule the comparison of corresponding list elements. Elements
+  // that are the same object need no further comparison.
+  template<typename T>
+  bool push(List<T> const& a, List<T> const& b)
   {
-    Type const& t2;
-    bool operator()(Type const& t1) const           { lingo_unhandled(t1); }
-    bool operator()(Void_type const& t1) const      { return always_equal(t1, cast<Void_type>(t2)); }
-    bool operator()(Boolean_type const& t1) const   { return always_equal(t1, cast<Boolean_type>(t2)); }
-    bool operator()(Byte_type const& t1) const      { return always_equal(t1, cast<Byte_type>(t2)); }
-    bool operator()(Integer_type const& t1) const   { return is_equivalent(t1, cast<Integer_type>(t2)); }
-    bool operator()(Float_type const& t1) const     { return is_equivalent(t1, cast<Float_type>(t2)); }
-    bool operator()(Auto_type const& t1) const      { return is_equivalent(t1, cast<Auto_type>(t2)); }
-    bool operator()(Decltype_type const& t1) const  { return is_equivalent(t1, cast<Decltype_type>(t2)); }
-    bool operator()(Declauto_type const& t1) const  { return is_equivalent(t1, cast<Declauto_type>(t2)); }
-    bool operator()(Function_type const& t1) const  { return is_equivalent(t1, cast<Function_type>(t2)); }
-    bool operator()(Qualified_type const& t1) const { return is_equivalent(t1, cast<Qualified_type>(t2)); }
-    bool operator()(Unary_type const& t1) const     { return is_equivalent(t1, cast<Unary_type>(t2)); }
-    bool operator()(Array_type const& t1) const     { return is_equivalent(t1, cast<Array_type>(t2)); }
-    bool operator()(Dynarray_type const& t1) const  { return is_equivalent(t1, cast<Dynarray_type>(t2)); }
-    bool operator()(User_type const& t1) const      { return is_equivalent(t1, cast<User_type>(t2)); }
-  };
-
-  // The same objects represent the same types.
-  if (&t1 == &t2)
+    std::vector<T*> const& v1 = a.base();
+    std::vector<T*> const& v2 = b.base();
+    if (v1.size() != v2.size())
+      return false;
+    for (std::size_t i = 0; i < v1.size(); ++i)
+      if (v1[i] != v2[i])
+        work.emplace_back(v1[i], v2[i]);
     return true;
+  }
+
+  // Names
+  bool operator()(Name const& n)        { lingo_unreachable(); }
+  bool operator()(Simple_id const& n)   { return &n.symbol() == &other<Simple_id>().symbol(); }
+  bool operator()(Placeholder_id const& n) { return n.number() == other<Placeholder_id>().number(); }
+  bool operator()(Operator_id const& n) { return n.kind() == other<Operator_id>().kind(); }
+
+  // Types. Two placeholder types or synthetic types are equivalent
+  // only when they are identical. Here, they are known not to be.
+  //
+  // TODO: When are two placeholder types equivalent?
+  //
+  // TODO: The extent of array types must be equivalent.
+  bool operator()(Type const& t)           { lingo_unhandled(t); }
+  bool operator()(Void_type const& t)      { return true; }
+  bool operator()(Boolean_type const& t)   { return true; }
+  bool operator()(Byte_type const& t)      { return true; }
+  bool operator()(Integer_type const& t)   { return is_equivalent(t, other<Integer_type>()); }
+  bool operator()(Float_type const& t)     { return t.precision() == other<Float_type>().precision(); }
+  bool operator()(Auto_type const& t)      { return false; }
+  bool operator()(Decltype_type const& t)  { lingo_unreachable(); }
+  bool operator()(Declauto_type const& t)  { return false; }
+  bool operator()(Function_type const& t)  { return is_equivalent(t, other<Function_type>()); }
+  bool operator()(Qualified_type const& t) { return is_equivalent(t, other<Qualified_type>()); }
+  bool operator()(Unary_type const& t)     { return push(t.type(), other<Unary_type>().type()); }
+  bool operator()(Array_type const& t)     { lingo_unreachable(); }
+  bool operator()(Dynarray_type const& t)  { lingo_unreachable(); }
+  bool operator()(User_type const& t)      { return push(t.declaration(), other<User_type>().declaration()); }
+  bool operator()(Synthetic_type const& t) { return false; }
+
+  bool is_equivalent(Integer_type const& t1, Integer_type const& t2)
+  {
+    return t1.is_signed() == t2.is_signed() && t1.precision() == t2.precision();
+  }
 
-  // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(t1);
-  std::type_index ti2 = typeid(t2);
-  if (ti1 != ti2)
-    return false;
+  bool is_equivalent(Function_type const& t1, Function_type const& t2)
+  {
+    return push(t1.parameter_types(), t2.parameter_types())
+        && push(t1.return_type(), t2.return_type());
+  }
 
-  // Find a comparison of the types.
-  return apply(t1, fn{t2});
-}
+  bool is_equivalent(Qualified_type const& t1, Qualified_type const& t2)
+  {
+    return t1.qualifier() == t2.qualifier() && push(t1.type(), t2.type());
+  }
+
+  // Expressions
+  bool operator()(Expr const& e)         { banjo_unhandled_case(e); }
+  bool operator()(Boolean_expr const& e) { return e.value() == other<Boolean_expr>().value(); }
+  bool operator()(Integer_expr const& e) { return e.value() == other<Integer_expr>().value(); }
+  bool operator()(Decl_expr const& e)    { return push(e.declaration(), other<Decl_expr>().declaration()); }
+  bool operator()(Unary_expr const& e)   { return push(e.operand(), other<Unary_expr>().operand()); }
+  bool operator()(Binary_expr const& e)  { return is_equivalent(e, other<Binary_expr>()); }
+  bool operator()(Call_expr const& e)    { return is_equivalent(e, other<Call_expr>()); }
+  bool operator()(Conv const& e)         { return is_equivalent(e, other<Conv>()); }
+
+  bool is_equivalent(Binary_expr const& e1, Binary_expr const& e2)
+  {
+    return push(e1.left(), e2.left()) && push(e1.right(), e2.right());
+  }
 
+  bool is_equivalent(Call_expr const& e1, Call_expr const& e2)
+  {
+    return push(e1.function(), e2.function())
+        && push(e1.arguments(), e2.arguments());
+  }
 
-// -------------------------------------------------------------------------- //
-// Expressions
+  bool is_equivalent(Conv const& e1, Conv const& e2)
+  {
+    return push(e1.destination(), e2.destination())
+        && push(e1.source(), e2.source());
+  }
+
+  // Declarations. Two declarations are equivalent when they declare
+  // the same entity.
+  //
+  // TODO: When we allow redeclaration, then this comparison must be
+  // use the entity, not object identity.
+  //
+  // FIXME: This is wrong. Two template parameters are equivalent when
+  // they have equal indexes (depth, offset). For example:
+  //
+  //    template<typename T> void f(T);
+  //    template<typename U> void f(U*);
+  //
+  // Here, T and U are equivalent.
+  bool operator()(Decl const& d) { return &d == &y; }
+
+  // Constraints
+  bool operator()(Cons const& c)               { banjo_unhandled_case(c); }
+  bool operator()(Concept_cons const& c)       { return is_equivalent(c, other<Concept_cons>()); }
+  bool operator()(Predicate_cons const& c)     { return push(c.expression(), other<Predicate_cons>().expression()); }
+  bool operator()(Expression_cons const& c)    { return is_eq_usage(c, other<Expression_cons>()); }
+  bool operator()(Conversion_cons const& c)    { return is_eq_usage(c, other<Conversion_cons>()); }
+  bool operator()(Parameterized_cons const& c) { return is_equivalent(c, other<Parameterized_cons>()); }
+  bool operator()(Binary_cons const& c)        { return is_equivalent(c, other<Binary_cons>()); }
+
+  // Two unexpanded constraints are equivalent when they refer to
+  // the same declaration and have the same template arguments.
+  bool is_equivalent(Concept_cons const& c1, Concept_cons const& c2)
+  {
+    return push(c1.declaration(), c2.declaration())
+        && push(c1.arguments(), c2.arguments());
+  }
 
-template<typename T>
-bool
-is_equivalent(Literal_expr<T> const& e1, Literal_expr<T> const& e2)
-{
-  return e1.value() == e2.value();
-}
+  template<typename T>
+  bool is_eq_usage(T const& c1, T const& c2)
+  {
+    return push(c1.expression(), c2.expression())
+        && push(c1.type(), c2.type());
+  }
 
+  // FIXME: Also compare template parameters?
+  bool is_equivalent(Parameterized_cons const& c1, Parameterized_cons const& c2)
+  {
+    return push(c1.variables(), c2.variables())
+        && push(c1.constraint(), c2.constraint());
+  }
 
-bool
-is_equivalent(Decl_expr const& e1, Decl_expr const& e2)
-{
-  return is_equivalent(e1.declaration(), e2.declaration());
-}
+  bool is_equivalent(Binary_cons const& c1, Binary_cons const& c2)
+  {
+    return push(c1.left(), c2.left()) && push(c1.right(), c2.right());
+  }
 
-
-bool
-is_equivalent(Unary_expr const& e1, Unary_expr const& e2)
-{
-  return is_equivalent(e1.operand(), e2.operand());
-}
+  Term const& y;
+  Work_list&  work;
+};
 
 
+// Compare the terms x and y, which are not the same object.
 bool
-is_equivalent(Binary_expr const& e1, Binary_expr const& e2)
+compare(Term const& x, Term const& y, Work_list& work)
 {
-  return is_equivalent(e1.left(), e2.left())
-      && is_equivalent(e1.right(), e2.right());
-}
+  // Terms with different hash values are not equivalent.
+  std::size_t hx = x.hc.load(std::memory_order_relaxed);
+  std::size_t hy = y.hc.load(std::memory_order_relaxed);
+  if (hx && hy && hx != hy)
+    return false;
 
+  // Terms of different kinds are not equivalent.
+  if (!is_same_kind(x, y))
+    return false;
 
-bool
-is_equivalent(Call_expr const& e1, Call_expr const& e2)
-{
-  return is_equivalent(e1.function(), e2.function())
-      && is_equivalent(e1.arguments(), e2.arguments());
+  Compare fn{y, work};
+  if (Name const* n = as<Name>(&x))
+    return apply(*n, fn);
+  if (Type const* t = as<Type>(&x))
+    return apply(*t, fn);
+  if (Expr const* e = as<Expr>(&x))
+    return apply(*e, fn);
+  if (Decl const* d = as<Decl>(&x))
+    return apply(*d, fn);
+  if (Cons const* c = as<Cons>(&x))
+    return apply(*c, fn);
+  banjo_unhandled_case(x);
 }
 
 
-bool
-is_equivalent(Conv const& e1, Conv const& e2)
-{
-  return is_equivalent(e1.destination(), e2.destination())
-      && is_equivalent(e1.source(), e2.source());
-}
+} // namespace
 
 
+// Returns true when the terms x1 and x2 are equivalent.
 bool
-is_equivalent(Expr const& e1, Expr const& e2)
+is_equivalent(Term const& x1, Term const& x2)
 {
-  struct fn
-  {
-    Expr const& e2;
-    bool operator()(Expr const& e) const          { banjo_unhandled_case(e); }
-    bool operator()(Boolean_expr const& e1) const { return is_equivalent(e1, cast<Boolean_expr>(e2)); }
-    bool operator()(Integer_expr const& e1) const { return is_equivalent(e1, cast<Integer_expr>(e2)); }
-    bool operator()(Decl_expr const& e1) const    { return is_equivalent(e1, cast<Decl_expr>(e2)); }
-    bool operator()(Unary_expr const& e1) const   { return is_equivalent(e1, cast<Unary_expr>(e2)); }
-    bool operator()(Binary_expr const& e1) const  { return is_equivalent(e1, cast<Binary_expr>(e2)); }
-    bool operator()(Call_expr const& e1) const    { return is_equivalent(e1, cast<Call_expr>(e2)); }
-
-    bool operator()(Conv const& e1) const         { return is_equivalent(e1, cast<Conv>(e2)); }
-  };
-
-  // The same objects represent the same types.
-  if (&e1 == &e2)
+  // The same objects represent the same terms.
+  if (&x1 == &x2)
     return true;
 
-  // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(e1);
-  std::type_index ti2 = typeid(e2);
-  if (ti1 != ti2)
+  // Note that the work list is only allocated when the comparison
+  // reaches non-identical components.
+  Work_list work;
+  if (!compare(x1, x2, work))
     return false;
-
-  // Delegate to specific rules.
-  return apply(e1, fn{e2});
-}
-
-
-// -------------------------------------------------------------------------- //
-// Declarations
-//
-// Two declarations are equivalent when they declare the same
-// entity.
-//
-// TODO: When we allow redeclaration, then this comparison must be
-// use the entity, not object identity.
-
-
-// Two template parameters are equivalent when they have equal
-// indexes (depth, offset). For example:
-//
-//    template<typename T> void f(T);
-//    template<typename U> void f(U*);
-//
-// Here, T and U are equivalent.
-inline bool
-is_equivalent(Type_parm const& d1, Type_parm const& d2)
-{
-  return d1.index() == d2.index();
-}
-
-
-// FIXME: This is wrong.
-bool
-is_equivalent(Decl const& a, Decl const& b)
-{
-  struct fn
-  {
-    Decl const& d2;
-    bool operator()(Decl const& d1) const      { return &d1 == &d2; }
-    bool operator()(Type_parm const& d1) const { return is_equivalent(d1, cast<Type_parm>(d2)); }
-  };
-  return &a == &b;
-}
-
-
-// -------------------------------------------------------------------------- //
-// Constraints
-
-// Two unexpanded constraints are equivalent when they refer to
-// the same declaration and have the same template arguments.
-bool
-is_equivalent(Concept_cons const& c1, Concept_cons const& c2)
-{
-  return is_equivalent(c1.declaration(), c2.declaration())
-      && is_equivalent(c1.arguments(), c2.arguments());
+  while (!work.empty()) {
+    Term_pair p = work.back();
+    work.pop_back();
+    if (!compare(*p.first, *p.second, work))
+      return false;
+  }
+  return true;
 }
 
 
 bool
-is_equivalent(Predicate_cons const& c1, Predicate_cons const& c2)
+is_equivalent(Name const& n1, Name const& n2)
 {
-  return is_equivalent(c1.expression(), c2.expression());
+  return is_equivalent(static_cast<Term const&>(n1), static_cast<Term const&>(n2));
 }
 
 
-template<typename T>
 bool
-is_eq_usage(T const& c1, T const& c2)
+is_equivalent(Type const& t1, Type const& t2)
 {
-  return is_equivalent(c1.expression(), c2.expression())
-      && is_equivalent(c1.type(), c2.type());
+  return is_equivalent(static_cast<Term const&>(t1), static_cast<Term const&>(t2));
 }
 
 
-// FIXME: Also compare template parameters?
 bool
-is_eq_parm(Parameterized_cons const& c1, Parameterized_cons const& c2)
+is_equivalent(Expr const& e1, Expr const& e2)
 {
-  return is_equivalent(c1.variables(), c2.variables())
-      && is_equivalent(c1.constraint(), c2.constraint());
+  return is_equivalent(static_cast<Term const&>(e1), static_cast<Term const&>(e2));
 }
 
 
+// Declarations are equivalent only when they are the same object (see
+// the comments above).
 bool
-is_equivalent(Binary_cons const& c1, Binary_cons const& c2)
+is_equivalent(Decl const& d1, Decl const& d2)
 {
-  return is_equivalent(c1.left(), c2.left())
-      && is_equivalent(c1.right(), c2.right());
+  return &d1 == &d2;
 }
 
 
 bool
 is_equivalent(Cons const& c1, Cons const& c2)
 {
-  struct fn
-  {
-    Cons const& c2;
-    bool operator()(Cons const& c1) const               { banjo_unhandled_case(c1); }
-    bool operator()(Concept_cons const& c1) const       { return is_equivalent(c1, cast<Concept_cons>(c2)); }
-    bool operator()(Predicate_cons const& c1) const     { return is_equivalent(c1, cast<Predicate_cons>(c2)); }
-    bool operator()(Expression_cons const& c1) const    { return is_eq_usage(c1, cast<Expression_cons>(c2)); }
-    bool operator()(Conversion_cons const& c1) const    { return is_eq_usage(c1, cast<Conversion_cons>(c2)); }
-    bool operator()(Parameterized_cons const& c1) const { return is_eq_parm(c1, cast<Parameterized_cons>(c2)); }
-    bool operator()(Binary_cons const& c1) const        { return is_equivalent(c1, cast<Binary_cons>(c2)); }
-  };
-
-  // The same objects represent the same types.
-  if (&c1 == &c2)
-    return true;
-
-  // Types of different kinds are not the same.
-  std::type_index ti1 = typeid(c1);
-  std::type_index ti2 = typeid(c2);
-  if (ti1 != ti2)
-    return false;
-
-  // Delegate to specific rules.
-  return apply(c1, fn{c2});
+  return is_equivalent(static_cast<Term const&>(c1), static_cast<Term const&>(c2));
 }
 
 
@@ -25,14 +25,18 @@ bool is_equivalent(Decl const&, Decl const&);
 bool is_equivalent(Cons const&, Cons const&);
 
 
+// Two lists are equivalent when their corresponding elements are
+// equivalent. Elements are compared by identity before their structure
+// is compared.
 template<typename T>
 inline bool
 is_equivalent(List<T> const& a, List<T> const& b)
 {
-  auto cmp = [](T const& x, T const& y) {
-    return is_equivalent(x, y);
+  auto cmp = [](T const* x, T const* y) {
+    return x == y || is_equivalent(*x, *y);
   };
-  return std::equal(a.begin(), a.end(), b.begin(), b.end(), cmp);
+  return a.size() == b.size()
+      && std::equal(a.base().begin(), a.base().end(), b.base().begin(), cmp);
 }
 
 
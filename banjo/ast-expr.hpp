@@ -5,6 +5,7 @@
 #define BANJO_AST_EXPR_HPP
 
 #include "ast-base.hpp"
+#include "arena.hpp"
 
 
 namespace banjo
@@ -652,17 +653,16 @@ struct Synthetic_expr : Expr
 // Represents an unparsed expression.
 struct Unparsed_expr : Expr
 {
-  Unparsed_expr(Token_seq&& toks)
-    : Expr(untyped), toks(std::move(toks))
+  Unparsed_expr(Token_range toks)
+    : Expr(untyped), toks(toks)
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
 
-  Token_seq const& tokens() const { return toks; }
-  Token_seq&       tokens()       { return toks; }
+  Token_range tokens() const { return toks; }
 
-  Token_seq toks;
+  Token_range toks;
 };
 
 
@@ -908,6 +908,66 @@ struct Aggregate_init : Init
 };
 
 
+// -------------------------------------------------------------------------- //
+// Arena cleanup
+
+// These expressions hold only pointers and scalars, so destroying them
+// has no effect. They are not registered for cleanup by the arena.
+//
+// Expressions that own lists or values (e.g., calls and integer
+// literals) are still destroyed.
+#define define_trivial_node(Node) \
+template<> \
+struct Needs_cleanup<Node> : std::false_type { };
+
+define_trivial_node(Boolean_expr)
+define_trivial_node(Object_expr)
+define_trivial_node(Function_expr)
+define_trivial_node(Overload_expr)
+define_trivial_node(Field_expr)
+define_trivial_node(Method_expr)
+define_trivial_node(Member_expr)
+define_trivial_node(Add_expr)
+define_trivial_node(Sub_expr)
+define_trivial_node(Mul_expr)
+define_trivial_node(Div_expr)
+define_trivial_node(Rem_expr)
+define_trivial_node(Neg_expr)
+define_trivial_node(Pos_expr)
+define_trivial_node(Bit_and_expr)
+define_trivial_node(Bit_or_expr)
+define_trivial_node(Bit_xor_expr)
+define_trivial_node(Bit_lsh_expr)
+define_trivial_node(Bit_rsh_expr)
+define_trivial_node(Bit_not_expr)
+define_trivial_node(Eq_expr)
+define_trivial_node(Ne_expr)
+define_trivial_node(Lt_expr)
+define_trivial_node(Gt_expr)
+define_trivial_node(Le_expr)
+define_trivial_node(Ge_expr)
+define_trivial_node(Cmp_expr)
+define_trivial_node(And_expr)
+define_trivial_node(Or_expr)
+define_trivial_node(Not_expr)
+define_trivial_node(Assign_expr)
+define_trivial_node(Synthetic_expr)
+define_trivial_node(Unparsed_expr)
+define_trivial_node(Value_conv)
+define_trivial_node(Qualification_conv)
+define_trivial_node(Boolean_conv)
+define_trivial_node(Integer_conv)
+define_trivial_node(Float_conv)
+define_trivial_node(Numeric_conv)
+define_trivial_node(Dependent_conv)
+define_trivial_node(Ellipsis_conv)
+define_trivial_node(Trivial_init)
+define_trivial_node(Copy_init)
+define_trivial_node(Bind_init)
+
+#undef define_trivial_node
+
+
 // -------------------------------------------------------------------------- //
 // Operations on expressions
 
@@ -978,9 +1038,17 @@ struct Generic_expr_mutator : Expr::Mutator, Generic_mutator<F, T>
 
 // Apply a function to the given type.
 template<typename F, typename T = typename std::result_of<F(Boolean_expr const&)>::type>
-inline decltype(auto)
+inline T
 apply(Expr const& e, F fn)
 {
+  switch (e.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(e)));
+#include "ast-expr.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_expr_visitor<F, T> vis(fn);
   return accept(e, vis);
 }
@@ -988,9 +1056,17 @@ apply(Expr const& e, F fn)
 
 // Apply a function to the given type.
 template<typename F, typename T = typename std::result_of<F(Boolean_expr&)>::type>
-inline decltype(auto)
+inline T
 apply(Expr& e, F fn)
 {
+  switch (e.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(e)));
+#include "ast-expr.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_expr_mutator<F, T> vis(fn);
   return accept(e, vis);
 }
@@ -4,423 +4,299 @@
 #include "ast-hash.hpp"
 #include "ast.hpp"
 
-#include <typeinfo>
+#include <boost/functional/hash.hpp>
 
 
 namespace banjo
 {
 
-// Returns an initial hash value based on the dynamic type of T.
-template<typename T>
-std::size_t hash_type(T const& t)
+namespace
 {
-  return typeid(t).hash_code();
-}
-
 
 // -------------------------------------------------------------------------- //
-// Terms
-
-
-std::size_t
-hash_value(Term const& x)
-{
-  if (Name const* n = as<Name>(&x))
-    return hash_value(*n);
-  if (Type const* t = as<Type>(&x))
-    return hash_value(*t);
-  if (Expr const* e = as<Expr>(&x))
-    return hash_value(*e);
-  if (Decl const* d = as<Decl>(&x))
-    return hash_value(*d);
+// Dispatch
+
+// Apply fn to the term t.
+template<typename F>
+void
+apply_term(Term const& t, F fn)
+{
+  if (Name const* n = as<Name>(&t))
+    return apply(*n, fn);
+  if (Type const* t1 = as<Type>(&t))
+    return apply(*t1, fn);
+  if (Expr const* e = as<Expr>(&t))
+    return apply(*e, fn);
+  if (Decl const* d = as<Decl>(&t))
+    return apply(*d, fn);
+  if (Cons const* c = as<Cons>(&t))
+    return apply(*c, fn);
   lingo_unreachable();
 }
 
-// -------------------------------------------------------------------------- //
-// Names
-
-inline std::size_t
-hash_value(Simple_id const& n)
-{
-  std::size_t h = hash_type(n);
-  boost::hash_combine(h, &n.symbol());
-  return h;
-}
-
 
-inline std::size_t
-hash_value(Global_id const& n)
+struct Get_kind
 {
-  return hash_type(n);
-}
-
+  template<typename T>
+  void operator()(T const&) { k = Kind_of<T>::value; }
 
-inline std::size_t
-hash_value(Placeholder_id const& n)
-{
-  std::size_t h = hash_type(n);
-  boost::hash_combine(h, n.number());
-  return h;
-}
+  Term_kind& k;
+};
 
 
-inline std::size_t
-hash_value(Operator_id const& n)
+// Returns the kind of a term. Terms not created by a builder have no
+// recorded kind, so it is recovered from the dynamic type.
+Term_kind
+kind_of(Term const& t)
 {
-  std::size_t h = hash_type(n);
-  boost::hash_combine(h, n.kind());
-  return h;
-}
-
-
-inline std::size_t
-hash_value(Conversion_id const&)
-{
-  lingo_unreachable();
-}
-
-
-inline std::size_t
-hash_value(Literal_id const&)
-{
-  lingo_unreachable();
-}
-
-
-inline std::size_t
-hash_value(Destructor_id const&)
-{
-  lingo_unreachable();
-}
-
-
-inline std::size_t
-hash_value(Template_id const&)
-{
-  lingo_unreachable();
-}
-
-
-inline std::size_t
-hash_value(Concept_id const&)
-{
-  lingo_unreachable();
-}
-
-
-inline std::size_t
-hash_value(Qualified_id const&)
-{
-  lingo_unreachable();
-}
-
-
-std::size_t
-hash_value(Name const& n)
-{
-  struct fn
-  {
-    std::size_t operator()(Simple_id const& n)      { return hash_value(n); }
-    std::size_t operator()(Global_id const& n)      { return hash_value(n); }
-    std::size_t operator()(Placeholder_id const& n) { return hash_value(n); }
-    std::size_t operator()(Operator_id const& n)    { return hash_value(n); }
-    std::size_t operator()(Conversion_id const& n)  { return hash_value(n); }
-    std::size_t operator()(Literal_id const& n)     { return hash_value(n); }
-    std::size_t operator()(Destructor_id const& n)  { return hash_value(n); }
-    std::size_t operator()(Template_id const& n)    { return hash_value(n); }
-    std::size_t operator()(Concept_id const& n)     { return hash_value(n); }
-    std::size_t operator()(Qualified_id const& n)   { return hash_value(n); }
-  };
-  return apply(n, fn{});
+  if (t.term_kind() != no_kind)
+    return t.term_kind();
+  Term_kind k = no_kind;
+  apply_term(t, Get_kind{k});
+  return k;
 }
 
 
 // -------------------------------------------------------------------------- //
-// Types
-
-template<typename T>
-inline std::size_t
-hash_nullary_type(T const& t)
-{
-  return hash_type(t);
-}
-
-
-inline std::size_t
-hash_integer(Integer_type const& t)
-{
-  std::size_t h = hash_type(t);
-  boost::hash_combine(h, t.sign());
-  boost::hash_combine(h, t.precision());
-  return h;
-}
-
-inline std::size_t
-hash_float(Float_type const& t)
-{
-  std::size_t h = hash_type(t);
-  boost::hash_combine(h, t.precision());
-  return h;
-}
-
-
-inline std::size_t
-hash_value(Auto_type const& t)
-{
-  lingo_unreachable();
-}
-
+// Components
 
-inline std::size_t
-hash_value(Decltype_type const&)
+// Calls f for each component term of a term that contributes to its
+// hash. The elements of a list are components of the term.
+template<typename F>
+struct Components
 {
-  lingo_unreachable();
-}
+  template<typename T>
+  void operator()(List<T> const& l)
+  {
+    for (T const& t : l)
+      f(t);
+  }
 
+  // Names have no components.
+  void operator()(Name const&) { }
 
-inline std::size_t
-hash_value(Declauto_type const& t)
-{
-  lingo_unreachable();
-}
+  // Types
+  void operator()(Type const&) { }
+  void operator()(User_type const& t)     { f(t.declaration()); }
+  void operator()(Function_type const& t) { (*this)(t.parameter_types()); f(t.return_type()); }
+  void operator()(Unary_type const& t)    { f(t.type()); }
 
+  // Expressions
+  void operator()(Expr const&) { }
+  void operator()(Id_expr const& e)     { f(e.id()); }
+  void operator()(Decl_expr const& e)   { f(e.declaration()); }
+  void operator()(Unary_expr const& e)  { f(e.operand()); }
+  void operator()(Binary_expr const& e) { f(e.left()); f(e.right()); }
+  void operator()(Call_expr const& e)   { f(e.function()); (*this)(e.arguments()); }
+  void operator()(Conv const& e)        { f(e.destination()); f(e.source()); }
 
-inline std::size_t
-hash_value(Function_type const& t)
-{
-  std::size_t h = hash_type(t);
-  boost::hash_combine(h, t.parameter_types());
-  boost::hash_combine(h, t.return_type());
-  return h;
-}
+  // Declarations are hashed by identity.
+  void operator()(Decl const&) { }
 
+  // Constraints
+  void operator()(Cons const&) { }
+  void operator()(Concept_cons const& c)       { f(c.declaration()); (*this)(c.arguments()); }
+  void operator()(Predicate_cons const& c)     { f(c.expression()); }
+  void operator()(Expression_cons const& c)    { f(c.expression()); f(c.type()); }
+  void operator()(Conversion_cons const& c)    { f(c.expression()); f(c.type()); }
+  void operator()(Parameterized_cons const& c) { (*this)(c.variables()); f(c.constraint()); }
+  void operator()(Binary_cons const& c)        { f(c.left()); f(c.right()); }
 
-// The hash value of a user-defined type is that of its declaration.
-inline std::size_t
-hash_udt(User_type const& t)
-{
-  std::size_t h = hash_type(t);
-  boost::hash_combine(h, t.declaration());
-  return h;
-}
+  F& f;
+};
 
 
-// Compute the hash value of a type.
-std::size_t
-hash_value(Type const& t)
+template<typename F>
+inline void
+for_each_component(Term const& t, F f)
 {
-  struct fn
-  {
-    std::size_t operator()(Type const& t) const           { lingo_unhandled(t); }
-    std::size_t operator()(Void_type const& t) const      { return hash_nullary_type(t); }
-    std::size_t operator()(Boolean_type const& t) const   { return hash_nullary_type(t); }
-    std::size_t operator()(Byte_type const& t) const      { return hash_nullary_type(t); }
-    std::size_t operator()(Integer_type const& t) const   { return hash_integer(t); }
-    std::size_t operator()(Float_type const& t) const     { return hash_float(t); }
-    std::size_t operator()(Auto_type const& t) const      { return hash_value(t); }
-    std::size_t operator()(Decltype_type const& t) const  { return hash_value(t); }
-    std::size_t operator()(Declauto_type const& t) const  { return hash_value(t); }
-    std::size_t operator()(User_type const& t) const  { return hash_udt(t); }
-    std::size_t operator()(Function_type const& t) const  { return hash_value(t); }
-    std::size_t operator()(Synthetic_type const& t) const { banjo_unhandled_case(t); }
-  };
-  return apply(t, fn{});
+  apply_term(t, Components<F>{f});
 }
 
 
 // -------------------------------------------------------------------------- //
-// Expressions
+// Values
+
+// Adds the non-term values of a term to a hash. Terms that cannot
+// appear in a hashed context are rejected.
+struct Values
+{
+  // Names
+  void operator()(Name const& n)           { lingo_unreachable(); }
+  void operator()(Simple_id const& n)      { h.add(&n.symbol()); }
+  void operator()(Global_id const& n)      { }
+  void operator()(Placeholder_id const& n) { h.add(n.number()); }
+  void operator()(Operator_id const& n)    { h.add(n.kind()); }
+
+  // Types. Note that placeholder and synthetic types are unique, so
+  // they are hashed by identity.
+  void operator()(Type const& t)           { lingo_unhandled(t); }
+  void operator()(Void_type const& t)      { }
+  void operator()(Boolean_type const& t)   { }
+  void operator()(Byte_type const& t)      { }
+  void operator()(Integer_type const& t)   { h.add(t.sign()); h.add(t.precision()); }
+  void operator()(Float_type const& t)     { h.add(t.precision()); }
+  void operator()(Auto_type const& t)      { h.add(&t); }
+  void operator()(Decltype_type const& t)  { h.add(&t); }
+  void operator()(Declauto_type const& t)  { h.add(&t); }
+  void operator()(User_type const& t)      { }
+  void operator()(Function_type const& t)  { h.add(t.parameter_types().size()); }
+  void operator()(Unary_type const& t)     { }
+  void operator()(Qualified_type const& t) { h.add(t.qualifier()); }
+  void operator()(Synthetic_type const& t) { h.add(&t); }
+
+  // Expressions
+  void operator()(Expr const& e)         { banjo_unhandled_case(e); }
+  void operator()(Boolean_expr const& e) { h.add(boost::hash<bool>()(e.value())); }
+  void operator()(Integer_expr const& e) { h.add(boost::hash<Integer>()(e.value())); }
+  void operator()(Id_expr const& e)      { }
+  void operator()(Decl_expr const& e)    { }
+  void operator()(Unary_expr const& e)   { }
+  void operator()(Binary_expr const& e)  { }
+  void operator()(Call_expr const& e)    { }
+  void operator()(Conv const& e)         { }
+
+  // Declarations are not hashed here (see hash_decl).
+  void operator()(Decl const& d) { lingo_unreachable(); }
+
+  // Constraints
+  void operator()(Cons const& c)               { banjo_unhandled_case(c); }
+  void operator()(Concept_cons const& c)       { }
+  void operator()(Predicate_cons const& c)     { }
+  void operator()(Expression_cons const& c)    { }
+  void operator()(Conversion_cons const& c)    { }
+  void operator()(Parameterized_cons const& c) { h.add(c.variables().size()); }
+  void operator()(Binary_cons const& c)        { }
+
+  Hasher& h;
+};
 
-template<typename T>
-std::size_t
-hash_value(Literal_expr<T> const& e)
-{
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.value());
-  return h;
-}
 
+// -------------------------------------------------------------------------- //
+// Hashing
 
+// Compute the hash value of a declaration. Because declarations
+// are unique, the hash is derived from the identity of the declaration.
+// Type parameters are hashed by their index.
 std::size_t
-hash_value(Id_expr const& e)
+hash_decl(Decl const& d)
 {
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.id());
-  return h;
+  Hasher h(kind_of(d));
+  if (Type_parm const* p = as<Type_parm>(&d)) {
+    h.add(p->index().depth());
+    h.add(p->index().offset());
+  } else {
+    h.add(&d);
+  }
+  return h.value();
 }
 
 
-std::size_t
-hash_value(Decl_expr const& e)
+// Returns true when the hash value of a component is available
+// without further computation.
+inline bool
+is_hashed(Term const& t)
 {
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.declaration());
-  return h;
+  return t.hc.load(std::memory_order_relaxed) || is<Decl>(&t);
 }
 
 
-std::size_t
-hash_value(Unary_expr const& e)
+// Returns the hash value of a component whose hash is available.
+inline std::size_t
+hashed_value(Term const& t)
 {
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.operand());
-  return h;
+  if (std::size_t h = t.hc.load(std::memory_order_relaxed))
+    return h;
+  return hash_decl(cast<Decl>(t));
 }
 
 
+// Compute the hash value of a term whose components have all been
+// hashed. Note that 0 is reserved to indicate a term that has not
+// been hashed.
 std::size_t
-hash_value(Binary_expr const& e)
+hash_term(Term const& t)
 {
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.left());
-  boost::hash_combine(h, e.right());
-  return h;
+  Hasher h(kind_of(t));
+  apply_term(t, Values{h});
+  for_each_component(t, [&h](Term const& c) {
+    h.add(hashed_value(c));
+  });
+  std::size_t v = h.value();
+  return v ? v : 1;
 }
 
 
-std::size_t
-hash_value(Call_expr const& e)
-{
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.function());
-  boost::hash_combine(h, e.arguments());
-  return h;
-}
+} // namespace
 
 
+// Returns the hash value of a term. Components are hashed before the
+// terms that contain them, using an explicit stack instead of recursion.
+// The hash value of each term is cached.
 std::size_t
-hash_conv(Conv const& e)
-{
-  std::size_t h = hash_type(e);
-  boost::hash_combine(h, e.destination());
-  boost::hash_combine(h, e.source());
-  return h;
+hash_value(Term const& t)
+{
+  if (is_hashed(t))
+    return hashed_value(t);
+
+  std::vector<Term const*> stack;
+  stack.reserve(16);
+  stack.push_back(&t);
+  while (!stack.empty()) {
+    Term const& x = *stack.back();
+    if (x.hc.load(std::memory_order_relaxed)) {
+      stack.pop_back();
+      continue;
+    }
+
+    // Push any components not yet hashed. If there are none, the
+    // term can be hashed.
+    std::size_t n = stack.size();
+    for_each_component(x, [&stack](Term const& c) {
+      if (!is_hashed(c))
+        stack.push_back(&c);
+    });
+    if (stack.size() == n) {
+      x.hc.store(hash_term(x), std::memory_order_relaxed);
+      stack.pop_back();
+    }
+  }
+  return t.hc.load(std::memory_order_relaxed);
 }
 
 
 std::size_t
-hash_value(Expr const& e)
+hash_value(Name const& n)
 {
-  struct fn
-  {
-    std::size_t operator()(Expr const& e) const           { banjo_unhandled_case(e); }
-    std::size_t operator()(Boolean_expr const& e) const   { return hash_value(e); }
-    std::size_t operator()(Integer_expr const& e) const   { return hash_value(e); }
-    std::size_t operator()(Id_expr const& e) const        { return hash_value(e); }
-    std::size_t operator()(Decl_expr const& e) const      { return hash_value(e); }
-    std::size_t operator()(Unary_expr const& e) const     { return hash_value(e); }
-    std::size_t operator()(Binary_expr const& e) const    { return hash_value(e); }
-    std::size_t operator()(Call_expr const& e) const      { return hash_value(e); }
-
-    std::size_t operator()(Conv const& e) const           { return hash_conv(e); }
-  };
-  return apply(e, fn{});
+  return hash_value(static_cast<Term const&>(n));
 }
 
 
-// -------------------------------------------------------------------------- //
-// Declartions
-
-// Compute the hash value of a declaration. Because declarations
-// are unique, the hash is derived from the identity of the declaration.
-
 std::size_t
-hash_decl(Decl const& d)
+hash_value(Type const& t)
 {
-  std::hash<Decl const*> h;
-  return h(&d);
+  return hash_value(static_cast<Term const&>(t));
 }
 
 
 std::size_t
-hash_parm(Type_parm const& d)
+hash_value(Expr const& e)
 {
-  std::size_t h = hash_type(d);
-  boost::hash_combine(h, d.index());
-  return h;
+  return hash_value(static_cast<Term const&>(e));
 }
 
 
 std::size_t
 hash_value(Decl const& d)
 {
-  struct fn
-  {
-    std::size_t operator()(Decl const& d)      { return hash_decl(d); }
-    std::size_t operator()(Type_parm const& d) { return hash_parm(d); }
-  };
-  return apply(d, fn{});
-}
-
-
-// -------------------------------------------------------------------------- //
-// Constraints
-
-std::size_t
-hash_value(Concept_cons const& c)
-{
-  std::size_t h = hash_type(c);
-  boost::hash_combine(h, c.declaration());
-  boost::hash_combine(h, c.arguments());
-  return h;
-}
-
-
-std::size_t
-hash_value(Predicate_cons const& c)
-{
-  std::size_t h = hash_type(c);
-  boost::hash_combine(h, c.expression());
-  return h;
-}
-
-
-template<typename T>
-std::size_t
-hash_usage(T const& c)
-{
-  std::size_t h = hash_type(c);
-  boost::hash_combine(h, c.expression());
-  boost::hash_combine(h, c.type());
-  return h;
+  return hash_decl(d);
 }
 
 
-std::size_t
-hash_parm(Parameterized_cons const& c)
-{
-  std::size_t h = hash_type(c);
-  boost::hash_combine(h, c.variables());
-  boost::hash_combine(h, c.constraint());
-  return h;
-}
-
-
-std::size_t
-hash_value(Binary_cons const& c)
-{
-  std::size_t h = hash_type(c);
-  boost::hash_combine(h, c.left());
-  boost::hash_combine(h, c.right());
-  return h;
-}
-
-
-
 std::size_t
 hash_value(Cons const& c)
 {
-  struct fn
-  {
-    std::size_t operator()(Cons const& c) const           { banjo_unhandled_case(c); }
-    std::size_t operator()(Concept_cons const& c) const   { return hash_value(c); }
-    std::size_t operator()(Predicate_cons const& c) const { return hash_value(c); }
-    std::size_t operator()(Expression_cons const& c) const { return hash_usage(c); }
-    std::size_t operator()(Conversion_cons const& c) const { return hash_usage(c); }
-    std::size_t operator()(Parameterized_cons const& c) const { return hash_parm(c); }
-    std::size_t operator()(Binary_cons const& c) const    { return hash_value(c); }
-  };
-  return apply(c, fn{});
+  return hash_value(static_cast<Term const&>(c));
 }
 
 
@@ -6,18 +6,65 @@
 
 // This module defines the hash function on AST nodes.
 //
-// TODO: Migrate this to use an iterative hash instead of Boost's hashing
-// library. It will generate better keys (although this is a big rewrite).
+// The hash of a term is computed from its kind and the hashes of its
+// components. Hashing is iterative, so deeply nested terms do not
+// exhaust the stack. The hash of each term is computed once and then
+// cached in the term. Declarations are hashed by identity and are
+// not cached.
 
 #include "ast-base.hpp"
 #include "ast-eq.hpp"
 
-#include <boost/functional/hash.hpp>
+#include <cstdint>
 
 
 namespace banjo
 {
 
+// An incremental hash function. Values are combined using a rotate
+// and multiply step, and the final value is passed through the
+// splitmix64 finalizer so that all bits of the result depend on all
+// bits of the input.
+struct Hasher
+{
+  explicit Hasher(std::uint64_t seed = 0)
+    : h(seed)
+  { }
+
+  void add(std::uint64_t);
+  void add(void const*);
+
+  std::size_t value() const;
+
+  std::uint64_t h;
+};
+
+
+inline void
+Hasher::add(std::uint64_t n)
+{
+  h = ((h << 5) | (h >> 59)) ^ n;
+  h *= 0x9e3779b97f4a7c15ull;
+}
+
+
+inline void
+Hasher::add(void const* p)
+{
+  add(reinterpret_cast<std::uintptr_t>(p));
+}
+
+
+inline std::size_t
+Hasher::value() const
+{
+  std::uint64_t x = h;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+
 std::size_t hash_value(Term const&);
 std::size_t hash_value(Name const&);
 std::size_t hash_value(Type const&);
@@ -30,17 +77,17 @@ template<typename T>
 inline std::size_t
 hash_value(List<T> const& list)
 {
-  std::size_t h = 0;
+  Hasher h(list.size());
   for (T const& t : list)
-    boost::hash_combine(h, t);
-  return h;
+    h.add(hash_value(t));
+  return h.value();
 }
 
 
 template<typename T>
 struct Term_hash
 {
-  bool operator()(T const* t) const
+  std::size_t operator()(T const* t) const
   {
     return hash_value(*t);
   }
@@ -11,6 +11,9 @@
 namespace banjo
 {
 
+struct Name_binding;
+
+
 // A name denotes an entity in a progam. Most forms of names are
 // ids, which denote use the of those entities in expressions, or
 // types.
@@ -25,6 +28,10 @@ struct Name : Term
   // Returns an unqualified representation of the name.
   virtual Name const& unqualified_name() const { return *this; }
   virtual Name&       unqualified_name()       { return *this; }
+
+  // The innermost binding of the name, if any. Only names that are
+  // unique within a context are bound (see scope.hpp).
+  mutable Name_binding* bindings = nullptr;
 };
 
 
@@ -268,9 +275,17 @@ struct Generic_name_mutator : Name::Mutator, Generic_mutator<F, T>
 
 // Apply a function to the given name.
 template<typename F, typename T = typename std::result_of<F(Simple_id const&)>::type>
-inline decltype(auto)
+inline T
 apply(Name const& n, F fn)
 {
+  switch (n.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(n)));
+#include "ast-name.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_name_visitor<F, T> vis(fn);
   return accept(n, vis);
 }
@@ -278,9 +293,17 @@ apply(Name const& n, F fn)
 
 // Apply a function to the given name.
 template<typename F, typename T = typename std::result_of<F(Simple_id&)>::type>
-inline decltype(auto)
+inline T
 apply(Name& n, F fn)
 {
+  switch (n.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(n)));
+#include "ast-name.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_name_mutator<F, T> vis(fn);
   return accept(n, vis);
 }
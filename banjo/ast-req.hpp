@@ -218,6 +218,14 @@ template<typename F, typename T = typename std::result_of<F(Type_req const&)>::t
 inline T
 apply(Req const& r, F fn)
 {
+  switch (r.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(r)));
+#include "ast-req.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_req_visitor<F, T> vis(fn);
   return accept(r, vis);
 }
@@ -228,6 +236,14 @@ template<typename F, typename T = typename std::result_of<F(Type_req&)>::type>
 inline T
 apply(Req& r, F fn)
 {
+  switch (r.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(r)));
+#include "ast-req.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_req_mutator<F, T> vis(fn);
   return accept(r, vis);
 }
@@ -281,6 +281,14 @@ template<typename F, typename T = typename std::result_of<F(Empty_stmt const&)>:
 inline T
 apply(Stmt const& s, F fn)
 {
+  switch (s.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(s)));
+#include "ast-stmt.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_stmt_visitor<F, T> vis(fn);
   return accept(s, vis);
 }
@@ -291,6 +299,14 @@ template<typename F, typename T = typename std::result_of<F(Empty_stmt&)>::type>
 inline T
 apply(Stmt& s, F fn)
 {
+  switch (s.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(s)));
+#include "ast-stmt.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_stmt_mutator<F, T> vis(fn);
   return accept(s, vis);
 }
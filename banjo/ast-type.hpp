@@ -422,17 +422,16 @@ struct Type_type : Type
 // Represents an unparsed type.
 struct Unparsed_type : Type
 {
-  Unparsed_type(Token_seq&& toks)
-    : toks(std::move(toks))
+  Unparsed_type(Token_range toks)
+    : toks(toks)
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
 
-  Token_seq const& tokens() const { return toks; }
-  Token_seq&       tokens()       { return toks; }
+  Token_range tokens() const { return toks; }
 
-  Token_seq toks;
+  Token_range toks;
 };
 
 
@@ -556,9 +555,17 @@ struct Generic_type_mutator : Type::Mutator, Generic_mutator<F, T>
 
 // Apply a function to the given type.
 template<typename F, typename T = typename std::result_of<F(Void_type const&)>::type>
-inline decltype(auto)
+inline T
 apply(Type const& t, F fn)
 {
+  switch (t.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node const&>(t)));
+#include "ast-type.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_type_visitor<F, T> vis(fn);
   return accept(t, vis);
 }
@@ -566,9 +573,17 @@ apply(Type const& t, F fn)
 
 // Apply a function to the given type.
 template<typename F, typename T = typename std::result_of<F(Void_type&)>::type>
-inline decltype(auto)
+inline T
 apply(Type& t, F fn)
 {
+  switch (t.term_kind()) {
+#define define_node(Node) \
+  case Node##_kind: return static_cast<T>(fn(static_cast<Node&>(t)));
+#include "ast-type.def"
+#undef define_node
+  default:
+    break;
+  }
   Generic_type_mutator<F, T> vis(fn);
   return accept(t, vis);
 }
@@ -3,67 +3,23 @@
 
 #include "builder.hpp"
 #include "context.hpp"
+#include "factory.hpp"
 #include "ast.hpp"
 
-#include <unordered_set>
-
 
 namespace banjo
 {
 
-// FIXME: Move this into lingo.
-//
-// A unique factory will only allocate new objects if they have not been
-// previously created.
-template<typename T, typename Hash, typename Eq>
-struct Hashed_unique_factory : std::unordered_set<T, Hash, Eq>
-{
-  template<typename... Args>
-  T& make(Args&&... args)
-  {
-    auto ins = this->emplace(std::forward<Args>(args)...);
-    return *const_cast<T*>(&*ins.first); // Yuck.
-  }
-};
-
-
-template<typename T>
-struct Hash
-{
-  std::size_t operator()(T const& t) const
-  {
-    return hash_value(t);
-  }
-
-  std::size_t operator()(List<T> const& t) const
-  {
-    return hash_value(t);
-  }
-};
-
-
-template<typename T>
-struct Eq
-{
-  bool operator()(T const& a, T const& b) const
-  {
-    return is_equivalent(a, b);
-  }
-
-  bool operator()(List<T> const& a, List<T> const& b) const
-  {
-    return is_equivalent(a, b);
-  }
-};
-
-
-template<typename T>
-using Factory = Hashed_unique_factory<T, Hash<T>, Eq<T>>;
-
-
 // -------------------------------------------------------------------------- //
 // Builder definition
 
+// Note that the context's arena may not be constructed when the
+// context initializes its builder; only its address is taken here.
+Builder::Builder(Context& cxt)
+  : cxt(cxt), mem(cxt.memory())
+{ }
+
+
 Symbol_table&
 Builder::symbols() { return cxt.symbols(); }
 
@@ -71,32 +27,42 @@ Builder::symbols() { return cxt.symbols(); }
 // -------------------------------------------------------------------------- //
 // Names
 
-// Returns a simple identifier with the given spelling.
+// Returns the simple identifier with the given spelling.
 //
-// TODO: Unique this?
+// Simple identifiers, operator identifiers, placeholders, and the
+// global identifier are unique within a context, so two such names
+// are equivalent if and only if they are the same object.
 Simple_id&
 Builder::get_id(char const* s)
 {
-  Symbol const* sym = symbols().put_identifier(identifier_tok, s);
-  return make<Simple_id>(*sym);
+  Symbol const* sym;
+  {
+    Lock_shared g(cxt);
+    sym = symbols().put_identifier(identifier_tok, s);
+  }
+  return get_id(*sym);
 }
 
 
-// Returns a simple identifier with the given spelling.
+// Returns the simple identifier with the given spelling.
 Simple_id&
 Builder::get_id(std::string const& s)
 {
-  Symbol const* sym = symbols().put_identifier(identifier_tok, s);
-  return make<Simple_id>(*sym);
+  Symbol const* sym;
+  {
+    Lock_shared g(cxt);
+    sym = symbols().put_identifier(identifier_tok, s);
+  }
+  return get_id(*sym);
 }
 
 
-// Returns a simple identifier for the given symbol.
+// Returns the simple identifier for the given symbol.
 Simple_id&
 Builder::get_id(Symbol const& sym)
 {
   lingo_assert(is<Identifier_sym>(&sym));
-  return make<Simple_id>(sym);
+  return cxt.unique()->simple_ids.make(sym);
 }
 
 
@@ -116,20 +82,20 @@ Builder::get_id(Token tok)
 }
 
 
-// Returns a placeholder for a name.
-//
-// TODO: Make placeholders unique. Globally?
+// Returns a new placeholder for a name. Each placeholder is distinct
+// from all others.
 Placeholder_id&
 Builder::get_id()
 {
-  return make<Placeholder_id>(cxt.get_unique_id());
+  return cxt.unique()->placeholder_ids.make(cxt.get_unique_id());
 }
 
 
+// Returns the operator identifier for the given operator.
 Operator_id&
 Builder::get_id(Operator_kind k)
 {
-  return make<Operator_id>(k);
+  return cxt.unique()->operator_ids.make(k);
 }
 
 
@@ -167,9 +133,7 @@ Builder::get_qualified_id(Decl& d, Name& n)
 Global_id&
 Builder::get_global_id()
 {
-  // TODO: Global or no?
-  static Global_id n;
-  return n;
+  return cxt.unique()->global_ids.make();
 }
 
 
@@ -179,34 +143,34 @@ Builder::get_global_id()
 User_type&
 Builder::get_type(Type_decl& d)
 {
-  return make<User_type>(d);
+  return cxt.unique()->user_types.make(d);
 }
 
 
 Void_type&
 Builder::get_void_type()
 {
-  return make<Void_type>();
+  return cxt.unique()->void_types.make();
 }
 
 
 Boolean_type&
 Builder::get_bool_type()
 {
-  return make<Boolean_type>();
+  return cxt.unique()->bool_types.make();
 }
 
 
 Integer_type&
 Builder::get_integer_type(bool s, int p)
 {
-  return make<Integer_type>(s, p);
+  return cxt.unique()->int_types.make(s, p);
 }
 
 Byte_type&
 Builder::get_byte_type()
 {
-  return make<Byte_type>();
+  return cxt.unique()->byte_types.make();
 }
 
 
@@ -229,7 +193,7 @@ Builder::get_uint_type()
 Float_type&
 Builder::get_float_type()
 {
-  return make<Float_type>();
+  return cxt.unique()->float_types.make();
 }
 
 
@@ -269,10 +233,14 @@ Builder::get_function_type(Decl_list const& ps, Type& r)
 Function_type&
 Builder::get_function_type(Type_list const& ts, Type& r)
 {
-  return make<Function_type>(ts, r);
+  return cxt.unique()->fn_types.make(ts, r);
 }
 
 
+// Returns the type t qualified by qual. If t is already qualified,
+// the qualifiers are merged. Note that canonical types are shared, so
+// the qualifiers of t are never modified.
+//
 // TODO: Do not build qualified types for functions or arrays.
 // Is that a hard error, or do we simply fold the const into
 // the return type and/or element type?
@@ -280,10 +248,10 @@ Qualified_type&
 Builder::get_qualified_type(Type& t, Qualifier_set qual)
 {
   if (Qualified_type* q = as<Qualified_type>(&t)) {
-    q->qual |= qual;
-    return *q;
+    qual |= q->qualifier();
+    return cxt.unique()->qual_types.make(q->type(), qual);
   }
-  return make<Qualified_type>(t, qual);
+  return cxt.unique()->qual_types.make(t, qual);
 }
 
 
@@ -304,14 +272,14 @@ Builder::get_volatile_type(Type& t)
 Pointer_type&
 Builder::get_pointer_type(Type& t)
 {
-  return make<Pointer_type>(t);
+  return cxt.unique()->ptr_types.make(t);
 }
 
 
 Reference_type&
 Builder::get_reference_type(Type& t)
 {
-  return make<Reference_type>(t);
+  return cxt.unique()->ref_types.make(t);
 }
 
 
@@ -325,7 +293,7 @@ Builder::get_array_type(Type&, Expr&)
 Slice_type&
 Builder::get_slice_type(Type& t)
 {
-  return make<Slice_type>(t);
+  return cxt.unique()->slice_types.make(t);
 }
 
 
@@ -339,49 +307,49 @@ Builder::get_dynarray_type(Type&, Expr&)
 In_type&
 Builder::get_in_type(Type& t)
 {
-  return make<In_type>(t);
+  return cxt.unique()->in_types.make(t);
 }
 
 
 Out_type&
 Builder::get_out_type(Type& t)
 {
-  return make<Out_type>(t);
+  return cxt.unique()->out_types.make(t);
 }
 
 
 Mutable_type&
 Builder::get_mutable_type(Type& t)
 {
-  return make<Mutable_type>(t);
+  return cxt.unique()->mutable_types.make(t);
 }
 
 
 Consume_type&
 Builder::get_consume_type(Type& t)
 {
-  return make<Consume_type>(t);
+  return cxt.unique()->consume_types.make(t);
 }
 
 
 Forward_type&
 Builder::get_forward_type(Type& t)
 {
-  return make<Forward_type>(t);
+  return cxt.unique()->forward_types.make(t);
 }
 
 
 Pack_type&
 Builder::get_pack_type(Type& t)
 {
-  return make<Pack_type>(t);
+  return cxt.unique()->pack_types.make(t);
 }
 
 
 Typename_type&
 Builder::get_typename_type(Decl& d)
 {
-  return make<Typename_type>(d);
+  return cxt.unique()->typename_types.make(d);
 }
 
 
@@ -492,6 +460,17 @@ Builder::make_reference(Function_decl& d)
 }
 
 
+// Get an expression that refers to a set of overloaded functions. The
+// expression is untyped; the function is selected by overload resolution
+// when the expression is called.
+Overload_expr&
+Builder::make_reference(Overload_set& ovl)
+{
+  Name& n = ovl.name();
+  return make<Overload_expr>(n, ovl);
+}
+
+
 Field_expr&
 Builder::make_member_reference(Expr& e, Field_decl& d)
 {
@@ -1129,62 +1108,52 @@ Builder::make_syntactic_requirement(Expr& e)
 // -------------------------------------------------------------------------- //
 // Constraints
 
-// FIXME: Save all uniqued terms in the context, not as global variables.
-
 Concept_cons&
 Builder::get_concept_constraint(Decl& d, Term_list const& ts)
 {
-  static Factory<Concept_cons> f;
-  return f.make(d, ts);
+  return cxt.unique()->concept_cons.make(d, ts);
 }
 
 
 Predicate_cons&
 Builder::get_predicate_constraint(Expr& e)
 {
-  static Factory<Predicate_cons> f;
-  return f.make(e);
+  return cxt.unique()->predicate_cons.make(e);
 }
 
 
 Expression_cons&
 Builder::get_expression_constraint(Expr& e, Type& t)
 {
-  static Factory<Expression_cons> f;
-  return f.make(e, t);
+  return cxt.unique()->expression_cons.make(e, t);
 }
 
 
 Conversion_cons&
 Builder::get_conversion_constraint(Expr& e, Type& t)
 {
-  static Factory<Conversion_cons> f;
-  return f.make(e, t);
-
+  return cxt.unique()->conversion_cons.make(e, t);
 }
 
 
 Parameterized_cons&
 Builder::get_parameterized_constraint(Decl_list const& ds, Cons& c)
 {
-  static Factory<Parameterized_cons> f;
-  return f.make(ds, c);
+  return cxt.unique()->parameterized_cons.make(ds, c);
 }
 
 
 Conjunction_cons&
 Builder::get_conjunction_constraint(Cons& c1, Cons& c2)
 {
-  static Factory<Conjunction_cons> f;
-  return f.make(c1, c2);
+  return cxt.unique()->conjunction_cons.make(c1, c2);
 }
 
 
 Disjunction_cons&
 Builder::get_disjunction_constraint(Cons& c1, Cons& c2)
 {
-  static Factory<Disjunction_cons> f;
-  return f.make(c1, c2);
+  return cxt.unique()->disjunction_cons.make(c1, c2);
 }
 
 
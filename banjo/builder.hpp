@@ -6,6 +6,8 @@
 #define BANJO_BUILDER_HPP
 
 #include "prelude.hpp"
+#include "arena.hpp"
+#include "ast-base.hpp"
 #include "token.hpp"
 #include "language.hpp"
 
@@ -25,9 +27,7 @@ namespace banjo
 // location, then it can be uniqued.
 struct Builder
 {
-  Builder(Context& cxt)
-    : cxt(cxt)
-  { }
+  Builder(Context&);
 
   // Names
   //
@@ -217,17 +217,16 @@ struct Builder
   // Resources
   Symbol_table& symbols();
 
-  // Allocate an objet of the given type.
-  //
-  // TODO: This is a placeholder for using a legitimate object
-  // pool in the context (or somewhere else).
+  // Allocate an object of the given type. The object is owned by
+  // the context's arena and released with it.
   template<typename T, typename... Args>
   T& make(Args&&... args)
   {
-    return *new T(std::forward<Args>(args)...);
+    return init_kind(mem.make<T>(std::forward<Args>(args)...));
   }
 
   Context& cxt;
+  Arena&   mem;
 };
 
 
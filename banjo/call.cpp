@@ -2,10 +2,14 @@
 // All rights reserved
 
 #include "call.hpp"
+#include "context.hpp"
 #include "initialization.hpp"
 #include "conversion.hpp"
+#include "overload.hpp"
 #include "builder.hpp"
 
+#include <algorithm>
+
 
 namespace banjo
 {
@@ -55,6 +59,99 @@ initialize_parameters(Context& cxt, Type_list& parms, Expr_list& args)
 }
 
 
+// Determine if the parameters after the first n can be initialized by
+// the corresponding arguments, without building the initializations.
+// This follows the same steps as initialize_parameters. The rank of
+// each of those initializations is appended to `ranks`.
+Init_probe
+probe_parameters(Context& cxt, Type_list& parms, Expr_list& args, std::size_t n, Rank_list& ranks)
+{
+  if (args.size() < parms.size())
+    return {false, exact_rank};
+
+  Conversion_rank rank = exact_rank;
+  Type_iter pi = parms.begin(), pn = parms.end();
+  Expr_iter ai = args.begin(), an = args.end();
+  for (std::size_t i = 0; i < n && pi != pn && ai != an; ++i) {
+    ++pi;
+    ++ai;
+  }
+  while (pi != pn && ai != an) {
+    Init_probe p = probe_copy_initialize(cxt, *pi, *ai);
+    if (!p)
+      return p;
+    ranks.push_back(p.rank);
+    rank = std::max(rank, p.rank);
+    ++pi;
+    ++ai;
+  }
+  return {true, rank};
+}
+
+
+Init_probe
+probe_parameters(Context& cxt, Type_list& parms, Expr_list& args)
+{
+  Rank_list ranks;
+  return probe_parameters(cxt, parms, args, 0, ranks);
+}
+
+
+// Determine the viability of `f` as a candidate for a call with the
+// given arguments, and the rank of each argument's conversion. No
+// converted arguments are built; use build_function_candidate for the
+// selected candidate.
+Function_candidate
+probe_function_candidate(Context& cxt, Function_decl& f, Expr_list& args)
+{
+  Type_list& parms = f.type().parameter_types();
+  Rank_list ranks;
+  Init_probe p = probe_parameters(cxt, parms, args, 0, ranks);
+  return {f, p.viable, std::move(ranks)};
+}
+
+
+// Returns the viable candidates in `ovl` for a call with the given
+// arguments. Only the functions taking as many parameters as there are
+// arguments are considered. Of those, the functions whose first
+// parameter cannot be initialized by the first argument are discarded
+// by probing each distinct first parameter type once. The remaining
+// parameters of the other functions are then probed.
+//
+// TODO: Consider functions with default arguments and ellipsis
+// parameters when those are supported.
+Candidate_list
+probe_candidates(Context& cxt, Overload_set& ovl, Expr_list& args)
+{
+  Candidate_list ret;
+  Arity_bucket* b = ovl.arity(args.size());
+  if (!b)
+    return ret;
+
+  // Functions without parameters are always viable.
+  if (args.empty()) {
+    for (Decl& d : b->fns)
+      ret.push_back(probe_function_candidate(cxt, cast<Function_decl>(d), args));
+    return ret;
+  }
+
+  Expr& arg = args.front();
+  for (Type* t : b->firsts) {
+    Init_probe first = probe_copy_initialize(cxt, *t, arg);
+    if (!first)
+      continue;
+    for (Decl& d : b->byfirst.find(t)->second) {
+      Function_decl& f = cast<Function_decl>(d);
+      Rank_list ranks {first.rank};
+      Init_probe p = probe_parameters(cxt, f.type().parameter_types(), args, 1, ranks);
+      if (p)
+        ret.emplace_back(f, true, std::move(ranks));
+    }
+  }
+  return ret;
+}
+
+
 Function_candidate
 build_function_candidate(Context& cxt, Function_decl& f, Expr_list& args)
 {
@@ -77,4 +174,57 @@ build_function_call(Context& cxt, Function_decl& f, Expr_list& args)
 }
 
 
+// Compare the viable candidates c1 and c2 for the same call. The
+// candidate c1 is better than c2 if none of its conversions has a
+// higher rank than the corresponding conversion of c2, and at least
+// one has a lower rank.
+//
+// TODO: Compare the conversion sequences themselves when the ranks are
+// the same (see compare(Standard_conversion_seq const&, ...)).
+Conversion_comp
+compare(Function_candidate const& c1, Function_candidate const& c2)
+{
+  bool better = false;
+  bool worse = false;
+  for (std::size_t i = 0; i < c1.ranks.size(); ++i) {
+    if (c1.ranks[i] < c2.ranks[i])
+      better = true;
+    else if (c2.ranks[i] < c1.ranks[i])
+      worse = true;
+  }
+  if (better && !worse)
+    return better_conv;
+  if (worse && !better)
+    return worse_conv;
+  return indistinct_conv;
+}
+
+
+// Resolve a call to the overloaded functions in `ovl` with the given
+// arguments. The candidates are probed (see probe_candidates), and only
+// the arguments of the selected function are converted. The selected
+// function is the viable candidate that is better than all others.
+Expr&
+resolve_function_call(Context& cxt, Overload_set& ovl, Expr_list& args)
+{
+  Candidate_list cands = probe_candidates(cxt, ovl, args);
+  if (cands.empty())
+    throw Type_error("no matching function for call to '{}'", ovl.name());
+
+  // If any candidate is better than all others, it is the last one
+  // found to be better than the current best. Check that it is.
+  Function_candidate* best = &cands.front();
+  for (Function_candidate& c : cands) {
+    if (compare(c, *best) == better_conv)
+      best = &c;
+  }
+  for (Function_candidate& c : cands) {
+    if (&c != best && compare(*best, c) != better_conv)
+      throw Type_error("call to '{}' is ambiguous", ovl.name());
+  }
+
+  return build_function_call(cxt, best->function(), args);
+}
+
+
 } // namespace banjo
@@ -6,21 +6,37 @@
 
 #include "prelude.hpp"
 #include "language.hpp"
+#include "conversion.hpp"
+#include "initialization.hpp"
+
+#include <vector>
 
 
 namespace banjo
 {
 
 struct Context;
+struct Overload_set;
+
+
+// The ranks of the conversions of each argument of a call.
+using Rank_list = std::vector<Conversion_rank>;
 
 
 // Represeents a candidate for overload resolution.
+//
+// A probed candidate has no converted arguments. Instead, it records
+// the rank of the conversion needed to initialize each parameter.
 struct Function_candidate
 {
   Function_candidate(Function_decl& f, Expr_list const& a, bool v)
     : fn(f), args(a), viable(v)
   { }
 
+  Function_candidate(Function_decl& f, bool v, Rank_list&& r)
+    : fn(f), args(), viable(v), ranks(std::move(r))
+  { }
+
   // Converts to true iff the candidate is viable.
   explicit operator bool() const { return viable; }
 
@@ -35,14 +51,25 @@ struct Function_candidate
   Function_decl& fn;
   Expr_list      args;
   bool           viable;
+  Rank_list      ranks;
 };
 
 
+using Candidate_list = std::vector<Function_candidate>;
+
+
 // TODO: Rename this to argument_initialize and move
 // it into the initialization module.
 Expr_list initialize_parameters(Context&, Type_list&, Expr_list&);
+Init_probe probe_parameters(Context&, Type_list&, Expr_list&);
+Init_probe probe_parameters(Context&, Type_list&, Expr_list&, std::size_t, Rank_list&);
+
+Function_candidate probe_function_candidate(Context&, Function_decl&, Expr_list&);
+Candidate_list probe_candidates(Context&, Overload_set&, Expr_list&);
+Conversion_comp compare(Function_candidate const&, Function_candidate const&);
 
 Expr& build_function_call(Context&, Function_decl&, Expr_list&);
+Expr& resolve_function_call(Context&, Overload_set&, Expr_list&);
 
 
 } // namespace banjo
@@ -181,7 +181,7 @@ admit_usage_expr(Context& cxt, Usage& c, Expr& e)
   };
 
   // An expression of a different kind prove admissibility.
-  if (typeid(c.expression()) != typeid(e))
+  if (!is_same_kind(c.expression(), e))
     return nullptr;
 
   return apply(e, fn{cxt, c});
@@ -322,9 +322,7 @@ admit_binary_conv(Context& cxt, Conversion_cons& c, Binary_expr& e)
   // prefer #1. Perhaps we should collect viable conversion
   // and then sort at the end. Note that this is true for simple
   // typings also.
-  //
-  // FIXME: Add constructors to the builder. This is just plain dumb.
-  return new Dependent_conv(c.type(), e);
+  return &cxt.make<Dependent_conv>(c.type(), e);
 }
 
 
@@ -341,7 +339,7 @@ admit_usage_conv(Context& cxt, Conversion_cons& c, Expr& e, Type& t)
 
   // An expression of a different kind prove admissibility.
   Expr& e2 = c.expression();
-  if (typeid(e2) != typeid(e))
+  if (!is_same_kind(e2, e))
     return nullptr;
 
   // If the expression's type is not equivalent to t, this constraint
@@ -4,6 +4,8 @@
 #include "context.hpp"
 #include "ast.hpp"
 #include "builder.hpp"
+#include "conversion.hpp"
+#include "factory.hpp"
 #include "scope.hpp"
 #include "token.hpp"
 
@@ -14,11 +16,18 @@ namespace banjo
 {
 
 Context::Context()
-  : Builder(*this), syms()
-  , global(&make_scope()), scope(nullptr)
+  : Builder(*this), mem(), uniq(&mem.make<Unique_terms>())
+  , convs(&mem.make<Conversion_cache>()), syms(), spells()
+  , input_buf(nullptr), input_tok(0)
+  , global(&mem.make<Scope>()), scope(nullptr), pool(nullptr)
   , id(0)
   , diags(false)
+  , lazy(false)
+  , memo(false)
+  , owner(nullptr), waiting(nullptr)
 {
+  set_scope(*global);
+
   // Initialize the color system. This is a process-level
   // configuration. Perhaps we we should only initialize
   // colors if the default output terminal is actually the
@@ -27,9 +36,30 @@ Context::Context()
 
   // Initialize all the tokens.
   init_tokens(syms);
+
+  // Save the keyword symbols so that the lexer need not look them up.
+  kws.resize(last_keyword_tok);
+  for (int k = first_keyword_tok + 1; k < last_keyword_tok; ++k)
+    kws[k] = syms.get(get_spelling(Token_kind(k)));
 }
 
 
+// Construct a worker context for the owner. The worker starts in the
+// global scope of its owner. Definitions are not deferred within a
+// worker, so nested definitions are elaborated by the same worker.
+Context::Context(Context* o)
+  : Builder(*this), mem(), uniq(o->uniq)
+  , convs(&mem.make<Conversion_cache>()), syms(), spells()
+  , input_buf(nullptr), input_tok(0)
+  , global(o->global), scope(o->global), pool(nullptr)
+  , id(0)
+  , diags(o->diags)
+  , lazy(false)
+  , memo(o->memo)
+  , owner(o), waiting(nullptr)
+{ }
+
+
 // Returns the context associated with the current scope or nullptr if
 // there is none.
 Decl*
@@ -7,45 +7,120 @@
 #include "prelude.hpp"
 #include "builder.hpp"
 #include "scope.hpp"
+#include "input.hpp"
+#include "token-buffer.hpp"
+#include "parse-memo.hpp"
+#include "dependency.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 
 namespace banjo
 {
 
 struct Scope;
+struct Unique_terms;
+struct Conversion_cache;
+struct Unique_access;
 
 
 // Used to associate scopes with declarations.
 using Scope_map = std::unordered_map<Decl*, Scope*>;
 
 
+// A sequence of symbols.
+using Symbol_seq = std::vector<Symbol const*>;
+
+
+// The elaboration state of a deferred function definition.
+enum Deferred_state
+{
+  unclaimed_def, // Not yet elaborated
+  claimed_def,   // Being elaborated by some context
+  finished_def   // Elaborated
+};
+
+
+// A function definition whose elaboration has been deferred, the scope
+// enclosing its declaration, and the context elaborating it, if any.
+struct Deferred_def
+{
+  Deferred_def(Scope& s)
+    : scope(&s), state(unclaimed_def), claim(nullptr)
+  { }
+
+  Scope*         scope;
+  Deferred_state state;
+  Context*       claim;
+};
+
+
+// Used to associate deferred definitions with their declarations.
+using Deferred_map = std::unordered_map<Decl*, Deferred_def>;
+
+
 // A repository of information to support translation.
 //
-// TODO: Add an allocator/object pool and management support.
+// All terms and scopes created during translation are allocated in
+// the context's arena, and are released with the context.
+//
+// Function definitions can be elaborated in parallel by worker
+// contexts (see make_worker). A worker has its own arena, scope state,
+// input location, and conversion cache. It shares the canonical terms,
+// symbols, and unique ids of its owner, and access to those is
+// serialized (see Lock_shared). The scopes of the owner are read-only
+// to its workers.
 //
 // TODO: Integrate diagnostics.
 struct Context : Builder
 {
   Context();
+  explicit Context(Context*);
 
   // Non-copyable
   Context(Context const&) = delete;
   Context& operator=(Context const&) = delete;
 
+  // Returns the memory arena.
+  Arena const& memory() const { return mem; }
+  Arena&       memory()       { return mem; }
+
   // Returns the symbol table.
-  Symbol_table const& symbols() const { return syms; }
-  Symbol_table&       symbols()       { return syms; }
+  Symbol_table const& symbols() const { return owner ? owner->syms : syms; }
+  Symbol_table&       symbols()       { return owner ? owner->syms : syms; }
+
+  // Returns the symbols of previously lexed spellings.
+  Spelling_map const& spellings() const { return spells; }
+  Spelling_map&       spellings()       { return spells; }
+
+  // Returns the buffer of tokens for the translation.
+  Token_buffer const& tokens() const { return toks; }
+  Token_buffer&       tokens()       { return toks; }
+
+  // Returns the symbol for the keyword token of kind k.
+  Symbol const* keyword_symbol(int k) const { return kws[k]; }
+
+  // Returns the tables of canonical terms.
+  Unique_access unique();
 
   // Unique ids
   int get_unique_id();
 
-  // Input location
-  Location input_location() const       { return input; }
-  void     input_location(Location loc) { input = loc; }
+  // Input location. The location of a token is resolved only when it
+  // is requested, since that may read the file of a mapped input.
+  Location input_location() const;
+  void     input_location(Location);
+  void     input_location(Token_buffer const&, Token_buffer::Index);
 
   // Scope management
   Scope& make_scope();
   Scope& make_scope(Decl&);
+  Scope& make_block_scope();
+  void   release_block_scope(Scope&);
   Scope& saved_scope(Decl&);
   void   set_scope(Scope&);
   Scope& current_scope();
@@ -57,27 +132,194 @@ struct Context : Builder
   // Diagnostic state
   bool diagnose_errors() const { return diags; }
 
+  // Returns the cache of standard conversions.
+  Conversion_cache& conversions() { return *convs; }
+
+  // Returns the dependencies between declarations.
+  Dependency_graph const& dependencies() const { return deps; }
+  Dependency_graph&       dependencies()       { return deps; }
+
+  // Deferred definitions
+  bool defer_definitions() const { return lazy; }
+  void defer_definitions(bool b) { lazy = b; }
+
+  // Parallel elaboration
+  bool     is_worker() const { return owner; }
+  Context& make_worker();
+  Scope*   claim_deferred(Decl&, bool&);
+  void     finish_deferred(Decl&);
+
+  // Parse memoization
+  bool              memoize_parses() const { return memo; }
+  void              memoize_parses(bool b) { memo = b; }
+  Memo_stats const& memo_statistics() const { return memos; }
+  Memo_stats&       memo_statistics()       { return memos; }
+
+  // Declared first so that it is destroyed last.
+  Arena         mem;   // The memory arena
+  Unique_terms* uniq;  // Tables of canonical terms
+  Conversion_cache* convs; // Standard conversions by type
+
   Symbol_table syms;   // The symbol table
-  Location     input;  // The input location
+  Spelling_map spells; // Symbols by spelling
+  Symbol_seq   kws;    // Keyword symbols by token kind
+  Token_buffer toks;   // The tokens of the translation
+
+  // The input location is either the token at input_tok in input_buf
+  // or, if there is no buffer, input.
+  Location            input;
+  Token_buffer const* input_buf;
+  Token_buffer::Index input_tok;
  
   // Scope information
   Scope*       global; // The global scope
   Scope*       scope;  // The current scope
   Scope_map    saved;  // Saved scopes.
 
+  // Storage for released block scopes.
+  struct Free_scope
+  {
+    Free_scope* next;
+  };
+  Free_scope* pool;
+
   // Store information for generating unique names.
-  int             id;     // The current id counter
+  std::atomic<int> id;    // The current id counter
 
   // Diagnostic state
   bool diags; // True if diagnostics should be emitted.
+
+  // Declaration elaboration
+  Dependency_graph deps; // Dependencies between declarations
+
+  // Deferred definitions
+  bool         lazy;     // True if function definitions are deferred
+  Deferred_map deferred; // Deferred functions and their states
+  Decl_list    pending;  // Deferred functions, in declaration order
+
+  // Parse memoization
+  bool       memo;  // True if speculative parses are memoized
+  Memo_stats memos; // Memo lookups by production
+
+  // Parallel elaboration. Workers own the terms they create, so they
+  // are kept until the translation is released.
+  Context*      owner;   // For a worker, the context that owns it
+  std::mutex    lock;    // Serializes access to state shared with workers
+  Deferred_def* waiting; // The definition this context is waiting for
+  std::condition_variable finished; // Signaled when a definition is done
+  std::vector<std::unique_ptr<Context>> workers;
 };
 
 
+// Serializes access to the state that a worker context shares with
+// its owner. This does nothing when the context is not a worker.
+struct Lock_shared
+{
+  Lock_shared(Context& cxt)
+  {
+    if (cxt.owner)
+      guard = std::unique_lock<std::mutex>(cxt.owner->lock);
+  }
+
+  std::unique_lock<std::mutex> guard;
+};
+
+
+// Provides access to the tables of canonical terms. Access is serialized
+// until the end of the full-expression in which this object is created.
+struct Unique_access
+{
+  Unique_access(Context& cxt)
+    : terms(*cxt.uniq), lock(cxt)
+  { }
+
+  Unique_terms* operator->() const { return &terms; }
+
+  Unique_terms& terms;
+  Lock_shared   lock;
+};
+
+
+inline Unique_access
+Context::unique()
+{
+  return Unique_access(*this);
+}
+
+
+// Returns a new worker context owned by this context.
+inline Context&
+Context::make_worker()
+{
+  workers.emplace_back(new Context(this));
+  return *workers.back();
+}
+
+
+// Claim the deferred function d for elaboration by this context. Returns
+// the scope enclosing d, and the caller must call finish_deferred() when
+// the definition has been elaborated. Otherwise, returns nullptr, and
+// sets `ok` to true if the definition of d is available.
+//
+// Workers claim deferred functions from their owner, so each definition
+// is elaborated exactly once. When d is being elaborated by another
+// context, this waits for that context to finish. However, if that
+// context is waiting (possibly indirectly) for a definition claimed by
+// this context, neither would finish. In that case, and when d is being
+// elaborated by this context, the definition is not available.
+inline Scope*
+Context::claim_deferred(Decl& d, bool& ok)
+{
+  Context& o = owner ? *owner : *this;
+  std::unique_lock<std::mutex> g(o.lock);
+  ok = true;
+  auto iter = o.deferred.find(&d);
+  if (iter == o.deferred.end())
+    return nullptr;
+  Deferred_def& def = iter->second;
+  while (def.state == claimed_def) {
+    Context* c = def.claim;
+    while (c != this && c->waiting && c->waiting->state == claimed_def)
+      c = c->waiting->claim;
+    if (c == this) {
+      ok = false;
+      return nullptr;
+    }
+    waiting = &def;
+    o.finished.wait(g);
+    waiting = nullptr;
+  }
+  if (def.state == finished_def)
+    return nullptr;
+  def.state = claimed_def;
+  def.claim = this;
+  return def.scope;
+}
+
+
+// Indicate that the deferred function d, claimed by this context, has
+// been elaborated, and wake any contexts waiting for it.
+inline void
+Context::finish_deferred(Decl& d)
+{
+  Context& o = owner ? *owner : *this;
+  {
+    std::lock_guard<std::mutex> g(o.lock);
+    Deferred_def& def = o.deferred.find(&d)->second;
+    def.state = finished_def;
+    def.claim = nullptr;
+  }
+  o.finished.notify_all();
+}
+
+
 // Returns a new general purpose scope.
 inline Scope&
 Context::make_scope()
 {
-  return *new Scope(current_scope());
+  Scope& s = mem.make<Scope>(current_scope());
+  s.linked = !owner;
+  return s;
 }
 
 
@@ -85,19 +327,51 @@ Context::make_scope()
 inline Scope&
 Context::make_scope(Decl& d)
 {
-  return *new Scope(current_scope(), d);
+  Scope& s = mem.make<Scope>(current_scope(), d);
+  s.linked = !owner;
+  return s;
+}
+
+
+// Returns a new block scope. Block scopes are short-lived, and must be
+// released with release_block_scope(), which recycles their storage.
+// Storage is only allocated when no released scope is available.
+inline Scope&
+Context::make_block_scope()
+{
+  void* p;
+  if (pool) {
+    p = pool;
+    pool = pool->next;
+  } else {
+    p = mem.allocate(sizeof(Scope), alignof(Scope));
+  }
+  Scope& s = *new (p) Scope(current_scope());
+  s.linked = !owner;
+  return s;
+}
+
+
+// Destroy a block scope and return its storage to the pool.
+inline void
+Context::release_block_scope(Scope& s)
+{
+  s.~Scope();
+  pool = new (&s) Free_scope{pool};
 }
 
 
 // Retrieve the saved scope for the declaration. If no such scope exists,
 // create one. Note that newly created saved scopes are linked to the current
-// scope.
+// scope. Workers also find the scopes saved by their owner.
 inline Scope&
 Context::saved_scope(Decl& d)
 {
   auto iter = saved.find(&d);
   if (iter != saved.end()) {
     return *iter->second;
+  } else if (owner && owner->saved.count(&d)) {
+    return *owner->saved.find(&d)->second;
   } else {
     Scope& s = make_scope(d);
     saved.emplace(&d, &s);
@@ -110,11 +384,33 @@ Context::saved_scope(Decl& d)
 // namespace, `s` must be linked through its enclosing scopes
 // to the global namespace.
 //
+// The scopes enclosing the previous scope, but not `s`, are made
+// invisible, and those enclosing `s` are made visible. When entering
+// or leaving a nested scope, only that scope is updated.
+//
+// Workers do not maintain visibility, since the scopes of their owner
+// are shared with other workers.
+//
 // Do not call this function directly. Use Context::Scope_sentinel
 // to enter a new scope, and guarantee cleanup and scope exit.
 inline void
 Context::set_scope(Scope& s)
 {
+  if (owner) {
+    scope = &s;
+    return;
+  }
+  Scope* p = scope;
+  Scope* q = &s;
+  while (p != q) {
+    if (!q || (p && p->depth >= q->depth)) {
+      p->visible = false;
+      p = p->parent;
+    } else {
+      q->visible = true;
+      q = q->parent;
+    }
+  }
   scope = &s;
 }
 
@@ -127,16 +423,54 @@ Context::current_scope()
 }
 
 
+// Returns the scope of the global namespace.
+inline Scope&
+Context::global_scope()
+{
+  return *global;
+}
+
+
 // Returns a unique id number and updates the context so that the
 // next id will be different than this one. This is primarily used
-// to maintain placeholder ids.
+// to maintain placeholder ids. Workers use the ids of their owner.
 inline int
 Context::get_unique_id()
 {
+  if (owner)
+    return owner->get_unique_id();
   return id++;
 }
 
 
+// Returns the current input location for a diagnostic.
+inline Location
+Context::input_location() const
+{
+  if (input_buf)
+    return input_buf->source_location(input_tok);
+  return input;
+}
+
+
+// Set the input location.
+inline void
+Context::input_location(Location loc)
+{
+  input = loc;
+  input_buf = nullptr;
+}
+
+
+// Set the input location to that of the nth token of the buffer b.
+inline void
+Context::input_location(Token_buffer const& b, Token_buffer::Index n)
+{
+  input_buf = &b;
+  input_tok = n;
+}
+
+
 // An RAII helper that manages the entry and exit of scopes.
 struct Enter_scope
 {
@@ -154,7 +488,7 @@ struct Enter_scope
 // goes out of scope.
 inline
 Enter_scope::Enter_scope(Context& cxt)
-  : cxt(cxt), prev(&cxt.current_scope()), alloc(&cxt.make_scope())
+  : cxt(cxt), prev(&cxt.current_scope()), alloc(&cxt.make_block_scope())
 {
   cxt.set_scope(*alloc);
 }
@@ -169,12 +503,13 @@ Enter_scope::Enter_scope(Context& c, Scope& s)
 }
 
 
-// Restore the previous scope and delete any allocated scopes.
+// Restore the previous scope and release any allocated scopes.
 inline
 Enter_scope::~Enter_scope()
 {
   cxt.set_scope(*prev);
-  delete alloc;
+  if (alloc)
+    cxt.release_block_scope(*alloc);
 }
 
 
@@ -184,16 +519,20 @@ Enter_scope::~Enter_scope()
 struct Save_input_location
 {
   Save_input_location(Context& c)
-    : cxt(c), prev(cxt.input_location())
+    : cxt(c), loc(c.input), buf(c.input_buf), tok(c.input_tok)
   { }
 
   ~Save_input_location()
   {
-    cxt.input_location(prev);
+    cxt.input = loc;
+    cxt.input_buf = buf;
+    cxt.input_tok = tok;
   }
 
-  Context& cxt;
-  Location prev;
+  Context&            cxt;
+  Location            loc;
+  Token_buffer const* buf;
+  Token_buffer::Index tok;
 };
 
 
@@ -242,29 +581,35 @@ using lingo::warning;
 using lingo::note;
 
 
-// Emit a formatted message at the current input position.
+// Emit a formatted message at the current input position. Messages
+// from workers are serialized.
 template<typename... Args>
 inline void
 error(Context& cxt, char const* msg, Args const&... args)
 {
+  Lock_shared g(cxt);
   error(cxt.input_location(), msg, args...);
 }
 
 
-// Emit a formatted message at the current input position.
+// Emit a formatted message at the current input position. Messages
+// from workers are serialized.
 template<typename... Args>
 inline void
 warning(Context& cxt, char const* msg, Args const&... args)
 {
+  Lock_shared g(cxt);
   warning(cxt.input_location(), msg, args...);
 }
 
 
-// Emit a formatted message at the current input position.
+// Emit a formatted message at the current input position. Messages
+// from workers are serialized.
 template<typename... Args>
 inline void
 note(Context& cxt, char const* msg, Args const&... args)
 {
+  Lock_shared g(cxt);
   note(cxt.input_location(), msg, args...);
 }
 
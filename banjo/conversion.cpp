@@ -8,7 +8,7 @@
 #include "initialization.hpp"
 #include "printer.hpp"
 
-#include <typeindex>
+#include <algorithm>
 #include <iostream>
 
 
@@ -31,10 +31,10 @@ namespace banjo
 // FIXME: Check that e's type is complete before invoking the
 // conversion.
 Expr&
-convert_object_to_value(Expr& e, Type& t)
+convert_object_to_value(Context& cxt, Expr& e, Type& t)
 {
   if (Reference_type* et = as<Reference_type>(&e.type()))
-    return *new Value_conv(et->type(), e);
+    return cxt.make<Value_conv>(et->type(), e);
   return e;
 }
 
@@ -42,10 +42,10 @@ convert_object_to_value(Expr& e, Type& t)
 // Perform at most one categorical conversion. There is currently
 // just one that could performed: object-to-value.
 Expr&
-convert_category(Expr& e, Type& t)
+convert_category(Context& cxt, Expr& e, Type& t)
 {
   if (!is<Reference_type>(&t))
-    return convert_object_to_value(e, t);
+    return convert_object_to_value(cxt, e, t);
   return e;
 }
 
@@ -55,10 +55,10 @@ convert_category(Expr& e, Type& t)
 
 // A value of integer type can be converted to bool.
 Expr&
-convert_to_bool(Expr& e, Boolean_type& t)
+convert_to_bool(Context& cxt, Expr& e, Boolean_type& t)
 {
   if (is<Integer_type>(&e.type()))
-    return *new Boolean_conv(t, e);
+    return cxt.make<Boolean_conv>(t, e);
   return e;
 }
 
@@ -75,7 +75,7 @@ convert_to_bool(Expr& e, Boolean_type& t)
 //
 // Also use a different conversion for bool-to-int?
 Expr&
-convert_to_wider_integer(Expr& e, Integer_type& t)
+convert_to_wider_integer(Context& cxt, Expr& e, Integer_type& t)
 {
   // A value of integer type can be converted...
   if (has_integer_type(e)) {
@@ -84,16 +84,16 @@ convert_to_wider_integer(Expr& e, Integer_type& t)
     // actually going to happen. Especially, if we convert
     // sign and widen simultaneously.
     if (et.precision() < t.precision())
-      return *new Integer_conv(t, e);
+      return cxt.make<Integer_conv>(t, e);
     else if (et.sign() != t.sign())
-      return *new Integer_conv(t, e);
+      return cxt.make<Integer_conv>(t, e);
     else
       return e;
   }
 
   // A value of type bool can be converted...
   if (is<Boolean_type>(&e.type()))
-    return *new Integer_conv(t, e);
+    return cxt.make<Integer_conv>(t, e);
 
   return e;
 }
@@ -148,7 +148,7 @@ convert_to_float(Expr& e, Float_type& t)
 //
 // TODO: Why are references not converted in C++?
 Expr&
-convert_value(Expr& e, Type& t)
+convert_value(Context& cxt, Expr& e, Type& t)
 {
   // Value conversions do not apply to reeference types.
   if (is<Reference_type>(&e.type()))
@@ -160,11 +160,11 @@ convert_value(Expr& e, Type& t)
 
   // Try a boolean conversion.
   if (Boolean_type* b = as<Boolean_type>(&u))
-    return convert_to_bool(e, *b);
+    return convert_to_bool(cxt, e, *b);
 
   // Try an integer conversion.
   if (Integer_type* z = as<Integer_type>(&u))
-    return convert_to_wider_integer(e, *z);
+    return convert_to_wider_integer(cxt, e, *z);
 
   // Try one of the floating point conversions.
   if (Float_type* f = as<Float_type>(&u))
@@ -241,7 +241,7 @@ is_similar(Type const& a, Type const& b)
   Type const& ua = a.unqualified_type();
   Type const& ub = b.unqualified_type();
 
-  if (typeid(ua) != typeid(ub))
+  if (!is_same_kind(ua, ub))
     return false;
   else
     return apply(ua, fn{ub});
@@ -349,6 +349,63 @@ can_convert_signature(Qualifier_list const& a, Qualifier_list const& b)
 }
 
 
+// Returns the qualifier of the type component t, and moves t to the
+// component it composes, or null if there is no such component.
+inline int
+next_qualifier(Type const*& t)
+{
+  int q = 0;
+  if (Qualified_type const* qt = as<Qualified_type>(t))
+    q = qt->qualifier();
+
+  Type const& u = t->unqualified_type();
+  if (Pointer_type const* p = as<Pointer_type>(&u))
+    t = &p->type();
+  else if (Slice_type const* s = as<Slice_type>(&u))
+    t = &s->type();
+  else if (is<Array_type>(&u) || is<Dynarray_type>(&u))
+    lingo_unreachable();
+  else
+    t = nullptr;
+  return q;
+}
+
+
+// Determine if the qualification signature of the type a can be
+// converted to that of the similar type b. This is equivalent to
+// comparing the signatures of those types with can_convert_signature,
+// but compares the qualifiers of each component as the types are
+// traversed instead of building the signatures.
+//
+// The signature lists the innermost component first, and the check
+// skips it. Traversing from the outermost component, once the
+// qualifiers first differ, each following component of b (except
+// the innermost) must be const.
+bool
+can_convert_qualification(Type const& a, Type const& b)
+{
+  Type const* ta = &a;
+  Type const* tb = &b;
+  bool differ = false;
+  while (ta && tb) {
+    int qa = next_qualifier(ta);
+    int qb = next_qualifier(tb);
+    if (!ta)
+      break; // Skip the innermost component.
+
+    if (has_const(qa) && !has_const(qb))
+      return false;
+    if (has_volatile(qa) && !has_volatile(qb))
+      return false;
+    if (differ && !has_const(qb))
+      return false;
+    if (qa != qb)
+      differ = true;
+  }
+  return true;
+}
+
+
 // -------------------------------------------------------------------------- //
 // Qualifications
 
@@ -358,14 +415,10 @@ can_convert_signature(Qualifier_list const& a, Qualifier_list const& b)
 // Note that the top-level cv-qualifiers can be removed by this
 // conversion since it applies to values (i.e., copies).
 Expr&
-convert_qualifier(Expr& e, Type& t)
+convert_qualifier(Context& cxt, Expr& e, Type& t)
 {
-  if (is_similar(e.type(), t)) {
-    Qualifier_list sa = get_qualification_signature(e.type());
-    Qualifier_list sb = get_qualification_signature(t);
-    if (can_convert_signature(sa, sb))
-      return *new Qualification_conv(t, e);
-  }
+  if (is_similar(e.type(), t) && can_convert_qualification(e.type(), t))
+    return cxt.make<Qualification_conv>(t, e);
   return e;
 }
 
@@ -374,38 +427,166 @@ convert_qualifier(Expr& e, Type& t)
 // Standard conversions
 
 // Try to find a standard conversion sequence from a source
-// expression `e` and a destination type `t`.
+// expression `e` and a destination type `t`. Each conversion is
+// found and built in turn, without consulting the conversions cached
+// by the context (see standard_conversion(Context&, Expr&, Type&)).
 //
 // FIXME: Should `t` be an object type? That is we should perform
 // conversions iff we can declare an object of type T?
 Expr&
-standard_conversion(Expr& e, Type& t)
+standard_conversion(Context& cxt, Expr const& e, Type const& t)
 {
-  Expr& c1 = convert_category(e, t);
-  if (is_equivalent(c1.type(), t))
+  // We strip the const qualifier because we're going to be
+  // building new terms.
+  Expr& e0 = modify(e);
+  Type& t0 = modify(t);
+
+  Expr& c1 = convert_category(cxt, e0, t0);
+  if (is_equivalent(c1.type(), t0))
     return c1;
 
-  Expr& c2 = convert_value(c1, t);
-  if (is_equivalent(c2.type(), t))
+  Expr& c2 = convert_value(cxt, c1, t0);
+  if (is_equivalent(c2.type(), t0))
     return c2;
 
-  Expr& c3 = convert_qualifier(c2, t);
-  if (is_equivalent(c3.type(), t))
+  Expr& c3 = convert_qualifier(cxt, c2, t0);
+  if (is_equivalent(c3.type(), t0))
     return c3;
 
   throw Type_error("cannot convert '{}' (type '{}') to '{}'", e, e.type(), t);
 }
 
 
-// Try to find a conversion from a source expression `e` and
-// a destination type `t`.
+// -------------------------------------------------------------------------- //
+// Conversion recipes
+
+namespace
+{
+
+// Append a step to the recipe, returning the type of the converted
+// value.
+inline Type&
+add_step(Conversion_recipe& r, Conversion_step s, Type& t)
+{
+  lingo_assert(r.size < Conversion_recipe::max_steps);
+  if (s != value_step && s != qualification_step)
+    r.rank = conversion_rank;
+  r.steps[r.size] = s;
+  r.types[r.size] = &t;
+  ++r.size;
+  return t;
+}
+
+
+// Append the value conversion from s to t, if any. This follows the
+// rules of convert_value.
+Type&
+add_value_step(Conversion_recipe& r, Type& s, Type& t)
+{
+  if (is<Reference_type>(&s))
+    return s;
+
+  Type& u = t.unqualified_type();
+  if (Boolean_type* b = as<Boolean_type>(&u)) {
+    if (is<Integer_type>(&s))
+      return add_step(r, boolean_step, *b);
+  } else if (Integer_type* z = as<Integer_type>(&u)) {
+    if (is_integer_type(s)) {
+      Integer_type& st = cast<Integer_type>(s);
+      if (st.precision() < z->precision() || st.sign() != z->sign())
+        return add_step(r, integer_step, *z);
+    } else if (is<Boolean_type>(&s)) {
+      return add_step(r, integer_step, *z);
+    }
+  }
+  return s;
+}
+
+
+// Apply the conversions of a recipe to e. The conversions are allocated
+// in the context.
 Expr&
-standard_conversion(Expr const& e, Type const& t)
+apply_recipe(Context& cxt, Conversion_recipe const& r, Expr& e)
 {
-  // Just forward to the non-const version of this function.
-  // We strip the const qualifier because we're going to be
-  // building new terms.
-  return standard_conversion(modify(e), modify(t));
+  Expr* p = &e;
+  for (int i = 0; i < r.size; ++i) {
+    Type& t = *r.types[i];
+    switch (r.steps[i]) {
+      case value_step:         p = &cxt.make<Value_conv>(t, *p); break;
+      case qualification_step: p = &cxt.make<Qualification_conv>(t, *p); break;
+      case boolean_step:       p = &cxt.make<Boolean_conv>(t, *p); break;
+      case integer_step:       p = &cxt.make<Integer_conv>(t, *p); break;
+      case float_step:         p = &cxt.make<Float_conv>(t, *p); break;
+      case numeric_step:       p = &cxt.make<Numeric_conv>(t, *p); break;
+    }
+  }
+  return *p;
+}
+
+
+} // namespace
+
+
+// Determine the standard conversions from an expression of type `s`
+// to the type `t` without building any expressions. This follows the
+// same steps as standard_conversion.
+Conversion_recipe
+get_conversion_recipe(Type& s, Type& t)
+{
+  Conversion_recipe r {true, exact_rank, 0, {}, {}};
+
+  // Categorical conversion.
+  Type* u = &s;
+  if (!is<Reference_type>(&t)) {
+    if (Reference_type* rt = as<Reference_type>(u))
+      u = &add_step(r, value_step, rt->type());
+  }
+  if (is_equivalent(*u, t))
+    return r;
+
+  // Value conversion.
+  u = &add_value_step(r, *u, t);
+  if (is_equivalent(*u, t))
+    return r;
+
+  // Qualification adjustment.
+  if (is_similar(*u, t) && can_convert_qualification(*u, t))
+    u = &add_step(r, qualification_step, t);
+  if (is_equivalent(*u, t))
+    return r;
+
+  r.ok = false;
+  return r;
+}
+
+
+// Returns the recipe for converting an expression of type `s` to `t`.
+// Recipes are cached by the context, so repeated queries for the same
+// types do not repeat the analysis.
+Conversion_recipe const&
+probe_standard_conversion(Context& cxt, Type& s, Type& t)
+{
+  Conversion_cache& cache = cxt.conversions();
+  Conversion_key key {&s, &t};
+  auto iter = cache.recipes.find(key);
+  if (iter != cache.recipes.end()) {
+    ++cache.hits;
+    return iter->second;
+  }
+  ++cache.misses;
+  return cache.recipes.emplace(key, get_conversion_recipe(s, t)).first->second;
+}
+
+
+// Find a standard conversion from `e` to `t`, using the conversions
+// previously found for the same source and destination types, if any.
+Expr&
+standard_conversion(Context& cxt, Expr& e, Type& t)
+{
+  Conversion_recipe const& r = probe_standard_conversion(cxt, e.type(), t);
+  if (!r.ok)
+    throw Type_error("cannot convert '{}' (type '{}') to '{}'", e, e.type(), t);
+  return apply_recipe(cxt, r, e);
 }
 
 
@@ -437,7 +618,7 @@ convert_to_common_float(Expr& e1, Expr& e2)
 }
 
 Expr_pair
-convert_to_common_int(Expr& e1, Expr& e2)
+convert_to_common_int(Context& cxt, Expr& e1, Expr& e2)
 {
   Integer_type& t1 = cast<Integer_type>(e1.type());
   Integer_type& t2 = cast<Integer_type>(e2.type());
@@ -446,25 +627,23 @@ convert_to_common_int(Expr& e1, Expr& e2)
   // the most precision.
   if (t1.sign() == t2.sign()) {
     if (t1.precision() < t2.precision())
-      return {convert_to_wider_integer(e1, t2), e2};
+      return {convert_to_wider_integer(cxt, e1, t2), e2};
     if (t2.precision() < t1.precision())
-      return {e1, convert_to_wider_integer(e2, t1)};
+      return {e1, convert_to_wider_integer(cxt, e2, t1)};
   }
 
   // If the unsigned operand has greater rank than the signed
   // operand, convert to the type of the unsigned operand.
   if (t1.is_unsigned() && t2.precision() < t1.precision())
-    return {e1, convert_to_wider_integer(e2, t1)};
+    return {e1, convert_to_wider_integer(cxt, e2, t1)};
   if (t2.is_unsigned() && t1.precision() < t2.precision())
-    return {convert_to_wider_integer(e1, t2), e2};
+    return {convert_to_wider_integer(cxt, e1, t2), e2};
 
   // Otherwise, both operands are converted to the corresponding
   // unsigned type of the signed operand.
-  //
-  // FIXME: Use a Builder (hence context) for this conversion.
   int p = t1.is_signed() ? t1.precision() : t2.precision();
-  Integer_type& c = *new Integer_type(false, p);
-  return {convert_to_wider_integer(e1, c), convert_to_wider_integer(e2, c)};
+  Integer_type& c = cxt.get_integer_type(false, p);
+  return {convert_to_wider_integer(cxt, e1, c), convert_to_wider_integer(cxt, e2, c)};
 }
 
 
@@ -489,7 +668,7 @@ convert_to_common_int(Expr& e1, Expr& e2)
 // conditional expression? Note that the arithmetic version converts
 // to values, and the conditional expression can retain references.
 Expr_pair
-arithmetic_conversion(Expr& e1, Expr& e2)
+arithmetic_conversion(Context& cxt, Expr& e1, Expr& e2)
 {
   // If the types are the same, no conversions are applied.
   if (is_equivalent(e1.type(), e2.type()))
@@ -504,7 +683,7 @@ arithmetic_conversion(Expr& e1, Expr& e2)
 
   // If both oerands have integer type, the following rules apply.
   if (has_integer_type(e1) && has_integer_type(e2))
-    return convert_to_common_int(e1, e2);
+    return convert_to_common_int(cxt, e1, e2);
 
   // TODO: No conversion from e1 to e2.
   throw Type_error("no usual arithmetic conversions for '{}' and '{}'", e1, e2);
@@ -512,9 +691,9 @@ arithmetic_conversion(Expr& e1, Expr& e2)
 
 
 Expr_pair
-arithmetic_conversion(Expr const& e1, Expr const& e2)
+arithmetic_conversion(Context& cxt, Expr const& e1, Expr const& e2)
 {
-  return arithmetic_conversion(modify(e1), modify(e2));
+  return arithmetic_conversion(cxt, modify(e1), modify(e2));
 }
 
 
@@ -680,9 +859,9 @@ dependent_conversion(Context& cxt, Expr& e, Type& t)
     // we need to also ensure that the type is copy constructible.
     // Note that copy constructible would also entail move
     // constructible.
-    Expr& c = standard_conversion(e, t);
+    Expr& c = standard_conversion(cxt, e, t);
     (void)c;
-    return *new Dependent_conv(t, e);
+    return cxt.make<Dependent_conv>(t, e);
   } catch (Translation_error&) {
     // Fall through...
   }
@@ -698,4 +877,17 @@ dependent_conversion(Context& cxt, Expr& e, Type& t)
 }
 
 
+// Determine if there is a dependent conversion from `e` to `t`, without
+// building it. This follows dependent_conversion, which currently admits
+// no conversions.
+//
+// TODO: When dependent_conversion searches the current constraints,
+// do the same here and rank the admitted conversion.
+bool
+probe_dependent_conversion(Context& cxt, Expr& e, Type& t)
+{
+  return false;
+}
+
+
 } // namespace banjo
@@ -7,6 +7,9 @@
 #include "prelude.hpp"
 #include "ast.hpp"
 
+#include <cstdint>
+#include <unordered_map>
+
 
 namespace banjo
 {
@@ -177,6 +180,85 @@ struct Conversion_seq
 };
 
 
+// -------------------------------------------------------------------------- //
+// Conversion cache
+//
+// The standard conversions from an expression to a type depend only on
+// the type of the expression (which includes its value category) and
+// the destination type. The conversions found for each pair of types
+// are recorded as a recipe, which is replayed for later expressions
+// with the same types. Recipes are found without building expressions,
+// so they can also be used to check for the existence and rank of a
+// conversion (e.g., for overload resolution).
+
+// A step of a standard conversion sequence.
+enum Conversion_step : std::uint8_t
+{
+  value_step,
+  qualification_step,
+  boolean_step,
+  integer_step,
+  float_step,
+  numeric_step,
+};
+
+
+// The conversions applied to convert an expression of one type to
+// another, in order of application. If ok is false, no conversion
+// exists.
+struct Conversion_recipe
+{
+  static constexpr int max_steps = 3;
+
+  bool            ok;
+  Conversion_rank rank;
+  int             size;
+  Conversion_step steps[max_steps];
+  Type*           types[max_steps];
+};
+
+
+// A source and destination type. Terms are compared by address, so
+// keys are most effective when types are canonical.
+struct Conversion_key
+{
+  Type const* source;
+  Type const* target;
+};
+
+
+struct Conversion_key_hash
+{
+  std::size_t operator()(Conversion_key const& k) const
+  {
+    Hasher h;
+    h.add(k.source);
+    h.add(k.target);
+    return h.value();
+  }
+};
+
+
+struct Conversion_key_eq
+{
+  bool operator()(Conversion_key const& a, Conversion_key const& b) const
+  {
+    return a.source == b.source && a.target == b.target;
+  }
+};
+
+
+// A cache of conversion recipes.
+struct Conversion_cache
+{
+  using Table = std::unordered_map<Conversion_key, Conversion_recipe, Conversion_key_hash, Conversion_key_eq>;
+
+  Table       recipes;
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+};
+
+
 // The results obtainable by a comparison of conversions and
 // conversion sequences.
 enum Conversion_comp
@@ -187,12 +269,15 @@ enum Conversion_comp
 };
 
 
-// FIXME: All of these should take a context.
+Expr&     standard_conversion(Context&, Expr const&, Type const&);
+Expr&     standard_conversion(Context&, Expr&, Type&);
 
-Expr&     standard_conversion(Expr const&, Type const&);
-Expr_pair arithmetic_conversion(Expr const&, Expr const&);
+Conversion_recipe        get_conversion_recipe(Type&, Type&);
+Conversion_recipe const& probe_standard_conversion(Context&, Type&, Type&);
+Expr_pair arithmetic_conversion(Context&, Expr const&, Expr const&);
 Expr&     contextual_conversion_to_bool(Context& cxt, Expr&);
 Expr&     dependent_conversion(Context& cxt, Expr&, Type&);
+bool      probe_dependent_conversion(Context& cxt, Expr&, Type&);
 
 Conversion_seq get_conversion_sequence(Expr const&);
 
@@ -201,6 +286,7 @@ Conversion_comp compare(Standard_conversion_seq const&, Standard_conversion_seq
 
 bool is_similar(Type const&, Type const&);
 Qualifier_list get_qualification_signature(Type const&);
+bool can_convert_qualification(Type const&, Type const&);
 
 
 } // namespace banjo
@@ -115,7 +115,7 @@ check_declarations(Context& cxt, Decl const& d1, Decl const& d2)
     void operator()(Type_decl const& d1)     { return check_declarations(cxt, d1, cast_as(d1, d2)); }
   };
 
-  if (typeid(d1) != typeid(d2)) {
+  if (!is_same_kind(d1, d2)) {
     // TODO: Get the source location right.
     error(cxt, "declaration changes the meaning of '{}'", d1.name());
     note("'{}' previously declared as:", d1.name());
@@ -145,10 +145,21 @@ check_declarations(Context& cxt, Object_decl const& d1, Object_decl const& d2)
 }
 
 
+// Function declarations that differ only in their return type cannot
+// be overloaded.
+//
+// FIXME: Actually check the remaining overloading rules.
 void
 check_declarations(Context& cxt, Function_decl const& d1, Function_decl const& d2)
 {
-  // FIXME: Actually check overloading rules.
+  Function_type const& t1 = d1.type();
+  Function_type const& t2 = d2.type();
+  if (is_equivalent(t1.parameter_types(), t2.parameter_types())) {
+    if (is_different(t1.return_type(), t2.return_type())) {
+      error(cxt, "cannot overload '{}' with a previous declaration", d2.name());
+      throw Declaration_error();
+    }
+  }
 }
 
 
@@ -0,0 +1,28 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "dependency.hpp"
+#include "ast.hpp"
+
+#include <algorithm>
+
+
+namespace banjo
+{
+
+// Record that the declaration user depends on the declaration used.
+void
+Dependency_graph::depend(Decl& user, Decl& used)
+{
+  Dependency_node* u = find(user);
+  Dependency_node* v = find(used);
+  if (!u || !v || &user == &used)
+    return;
+  if (std::find(u->uses.begin(), u->uses.end(), &used) != u->uses.end())
+    return;
+  u->uses.push_back(&used);
+  v->users.push_back(&user);
+}
+
+
+} // namespace banjo
@@ -0,0 +1,94 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_DEPENDENCY_HPP
+#define BANJO_DEPENDENCY_HPP
+
+// This module defines the graph of dependencies between declarations.
+//
+// Declarations are elaborated on demand. When elaborating one
+// declaration requires the type of another, the other is elaborated
+// first and an edge is recorded between them.
+
+#include "prelude.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+
+namespace banjo
+{
+
+struct Decl;
+struct Scope;
+
+
+using Decl_seq = std::vector<Decl*>;
+
+
+// The elaboration state of a declaration.
+enum Elaboration_state
+{
+  unelaborated_decl,
+  elaborating_decl,
+  elaborated_decl,
+};
+
+
+// A declaration in the dependency graph.
+struct Dependency_node
+{
+  Scope*            scope; // The scope enclosing the declaration
+  Elaboration_state state;
+  Decl_seq          uses;  // Declarations this one depends on
+  Decl_seq          users; // Declarations that depend on this one
+};
+
+
+// The dependencies between declarations. Declarations are added to
+// the graph before any of them are elaborated. The declarations being
+// elaborated are maintained as a stack; references made while
+// elaborating a declaration are dependencies of that declaration.
+struct Dependency_graph
+{
+  Dependency_node*       find(Decl const&);
+  Dependency_node const* find(Decl const&) const;
+
+  void add(Decl&, Scope&);
+  void depend(Decl&, Decl&);
+
+  Decl* current() const { return active.empty() ? nullptr : active.back(); }
+
+  std::unordered_map<Decl const*, Dependency_node> nodes;
+  Decl_seq active; // Declarations being elaborated
+};
+
+
+inline Dependency_node*
+Dependency_graph::find(Decl const& d)
+{
+  auto iter = nodes.find(&d);
+  return iter != nodes.end() ? &iter->second : nullptr;
+}
+
+
+inline Dependency_node const*
+Dependency_graph::find(Decl const& d) const
+{
+  auto iter = nodes.find(&d);
+  return iter != nodes.end() ? &iter->second : nullptr;
+}
+
+
+// Add the declaration d, declared in the scope s, to the graph.
+inline void
+Dependency_graph::add(Decl& d, Scope& s)
+{
+  nodes.emplace(&d, Dependency_node{&s, unelaborated_decl, {}, {}});
+}
+
+
+} // namespace banjo
+
+
+#endif
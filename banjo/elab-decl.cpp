@@ -11,12 +11,25 @@
 namespace banjo
 {
 
-// Elaborate the type of each declaration in turn. Note that elaboration
-// and "skip forward" if the type of one declaration depends on the type
-// or definition of another defined after it.
+// Elaborate the type of each declaration in turn.
+//
+// Declarations in namespace and type scopes are first added to the
+// dependency graph. Elaborating a declaration that refers to one
+// declared after it elaborates the later declaration on demand (see
+// require_declaration). Declarations in block scopes are elaborated
+// in order.
 void
 Parser::elaborate_declarations(Stmt_list& ss)
 {
+  Scope& scope = current_scope();
+  if (scope.decl || !scope.parent) {
+    Dependency_graph& deps = cxt.dependencies();
+    for (Stmt& s : ss) {
+      if (Declaration_stmt* s1 = as<Declaration_stmt>(&s))
+        deps.add(s1->declaration(), scope);
+    }
+  }
+
   for (Stmt& s : ss) {
     elaborate_declaration(s);
   }
@@ -26,8 +39,11 @@ Parser::elaborate_declarations(Stmt_list& ss)
 void
 Parser::elaborate_declaration(Stmt& s)
 {
-  if (Declaration_stmt* s1 = as<Declaration_stmt>(&s))
-    elaborate_declaration(s1->declaration());
+  if (Declaration_stmt* s1 = as<Declaration_stmt>(&s)) {
+    Decl& d = s1->declaration();
+    if (!require_declaration(cxt, d))
+      elaborate_declaration(d);
+  }
 }
 
 
@@ -90,10 +106,76 @@ Parser::elaborate_type(Type& t)
     Save_input_location loc(cxt);
     Token_stream ts(soup->tokens());
     Parser parse(cxt, ts);
-    return parse.type();
+    return parse.required(parse.type());
   }
   return t;
 }
 
 
+// -------------------------------------------------------------------------- //
+// On-demand elaboration
+
+namespace
+{
+
+// Marks a declaration as being elaborated. If elaboration fails, the
+// declaration is left in its previous state.
+struct Elaborating_decl
+{
+  Elaborating_decl(Dependency_graph& g, Decl& d, Dependency_node& n)
+    : graph(g), node(n), prev(n.state)
+  {
+    node.state = elaborating_decl;
+    graph.active.push_back(&d);
+  }
+
+  ~Elaborating_decl()
+  {
+    graph.active.pop_back();
+    if (node.state == elaborating_decl)
+      node.state = prev;
+  }
+
+  Dependency_graph& graph;
+  Dependency_node&  node;
+  Elaboration_state prev;
+};
+
+
+} // namespace
+
+
+// Ensure that the declaration d has been elaborated, recording that
+// the declaration currently being elaborated (if any) depends on it.
+// Returns false if d is not in the dependency graph.
+//
+// The declaration is elaborated in the scope where it was declared.
+// It is an error for a declaration to depend on itself.
+bool
+require_declaration(Context& cxt, Decl& d)
+{
+  Dependency_graph& deps = cxt.dependencies();
+  Dependency_node* node = deps.find(d);
+  if (!node)
+    return false;
+  if (Decl* user = deps.current())
+    deps.depend(*user, d);
+
+  if (node->state == elaborated_decl)
+    return true;
+  if (node->state == elaborating_decl) {
+    error(cxt, "declaration of '{}' depends on itself", d.name());
+    throw Declaration_error("recursive declaration");
+  }
+
+  Elaborating_decl guard(deps, d, *node);
+  Token_stream ts(Token_range{});
+  Parser parse(cxt, ts);
+  Enter_scope scope(cxt, *node->scope);
+  parse.elaborate_declaration(d);
+  node->state = elaborated_decl;
+  return true;
+}
+
+
 } // namespace banjo
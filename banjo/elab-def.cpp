@@ -4,8 +4,11 @@
 #include "parser.hpp"
 #include "printer.hpp"
 #include "declaration.hpp"
+#include "expression.hpp"
 #include "ast.hpp"
+#include "thread-pool.hpp"
 
+#include <atomic>
 #include <iostream>
 
 
@@ -74,12 +77,44 @@ Parser::elaborate_variable_initializer(Variable_decl& decl, Empty_def& def)
 void
 Parser::elaborate_variable_initializer(Variable_decl& decl, Expression_def& def)
 {
-  def.expr_ = &elaborate_expression(def.expression());
+  Expr& e = elaborate_expression(def.expression());
+  require_typed(cxt, e);
+  def.expr_ = &e;
+}
+
+
+// When definitions are deferred, record the scope enclosing the function
+// so that its definition can be elaborated on demand. Returns true if
+// the definition was deferred.
+//
+// Functions declared in a block scope are never deferred. Block scopes
+// are recycled when the block is left, so the enclosing scope would not
+// outlive the function body being elaborated.
+bool
+Parser::defer_function_definition(Function_decl& d)
+{
+  if (!cxt.defer_definitions())
+    return false;
+  Scope& s = current_scope();
+  if (!s.decl && s.parent)
+    return false;
+  cxt.deferred.emplace(&d, s);
+  cxt.pending.push_back(d);
+  return true;
 }
 
 
 void
 Parser::elaborate_function_definition(Function_decl& d)
+{
+  if (defer_function_definition(d))
+    return;
+  elaborate_function_body(d);
+}
+
+
+void
+Parser::elaborate_function_body(Function_decl& d)
 {
   struct fn
   {
@@ -173,7 +208,7 @@ Parser::elaborate_expression(Expr& e)
     Save_input_location loc(cxt);
     Token_stream ts(soup->tokens());
     Parser parse(cxt, ts);
-    return parse.expression();
+    return parse.required(parse.expression());
   }
   return e;
 }
@@ -205,4 +240,124 @@ Parser::elaborate_member_statement(Stmt& s)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Deferred definitions
+
+namespace
+{
+
+// Marks a claimed definition as finished when elaboration ends, even if
+// elaboration fails, so that no other context waits for it indefinitely.
+struct Finish_deferred
+{
+  Finish_deferred(Context& c, Decl& d)
+    : cxt(c), decl(d)
+  { }
+
+  ~Finish_deferred()
+  {
+    cxt.finish_deferred(decl);
+  }
+
+  Context& cxt;
+  Decl&    decl;
+};
+
+
+} // namespace
+
+
+// Elaborate the definition of d if it was deferred. This is called
+// when the definition is needed (e.g., by constant evaluation). The
+// definition is elaborated in the scope enclosing the function.
+//
+// Returns false if the definition is not available. This happens when
+// the definition is being elaborated by this context, or by another that
+// is waiting for this one (see Context::claim_deferred).
+bool
+elaborate_definition(Context& cxt, Function_decl& d)
+{
+  bool ok;
+  Scope* s = cxt.claim_deferred(d, ok);
+  if (!s)
+    return ok;
+
+  Finish_deferred finish(cxt, d);
+  Token_stream ts(Token_range{});
+  Parser parse(cxt, ts);
+  Enter_scope scope(cxt, *s);
+  parse.elaborate_function_body(d);
+  return true;
+}
+
+
+namespace
+{
+
+// Elaborate the definitions in fns using n threads. Each thread has its
+// own worker context, and so its own parser, arena, and scopes. The
+// scopes of the translation are not modified by workers.
+//
+// Definitions are claimed in order through a shared index, so threads
+// that finish early take on more of the remaining work. A thread that
+// needs a definition claimed by another (e.g., for constant evaluation)
+// waits until that definition has been elaborated.
+void
+elaborate_definitions_parallel(Context& cxt, Decl_list& fns, int n)
+{
+  if (std::size_t(n) > fns.size())
+    n = fns.size();
+  std::vector<Context*> workers;
+  for (int i = 0; i < n; ++i)
+    workers.push_back(&cxt.make_worker());
+
+  std::atomic<std::size_t> next(0);
+  {
+    Thread_pool pool(n);
+    for (Context* w : workers) {
+      pool.submit([&fns, &next, w]() {
+        for (std::size_t i = next++; i < fns.size(); i = next++)
+          elaborate_definition(*w, cast<Function_decl>(*fns.base()[i]));
+      });
+    }
+    pool.wait();
+  }
+
+  // Accumulate the memo statistics of the workers.
+  for (Context* w : workers) {
+    for (Memo_counts const& c : w->memo_statistics().rules) {
+      Memo_counts& r = cxt.memo_statistics().counts(c.rule);
+      r.hits += c.hits;
+      r.misses += c.misses;
+    }
+  }
+}
+
+
+} // namespace
+
+
+// Elaborate all deferred definitions. This is done before producing any
+// output. With more than one job, definitions are elaborated in parallel.
+// Otherwise, they are elaborated in declaration order.
+//
+// Elaborating one definition can defer others (e.g., the members of a
+// class required by that definition), so this continues until no
+// definitions are pending.
+void
+elaborate_deferred_definitions(Context& cxt, int jobs)
+{
+  while (!cxt.pending.empty()) {
+    Decl_list fns = std::move(cxt.pending);
+    cxt.pending = Decl_list();
+    if (jobs > 1 && fns.size() > 1) {
+      elaborate_definitions_parallel(cxt, fns, jobs);
+      continue;
+    }
+    for (Decl& d : fns)
+      elaborate_definition(cxt, cast<Function_decl>(d));
+  }
+}
+
+
 } // namespace banjo
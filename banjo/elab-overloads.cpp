@@ -29,29 +29,42 @@ Parser::elaborate_overloads(Stmt& s)
 }
 
 
+// Check the declarations d1 and d2, trapping declaration errors so
+// that we can diagnose as many as possible. Returns false if an error
+// was diagnosed.
+static bool
+check_overload(Context& cxt, Decl& d1, Decl& d2)
+{
+  try {
+    check_declarations(cxt, d1, d2);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+
+// Check the declaration against the previous declarations in its
+// overload set. Declarations are elaborated in order, so the previous
+// declarations have already been checked against each other.
+//
+// It is sufficient to check the declaration against the first in the
+// set, which determines the kind of declarations in the set, and then
+// against a previous function with the same parameter types, if any.
+// Both are found in constant time.
 void
 Parser::elaborate_overloads(Decl& decl)
 {
   Name& name = decl.name();
   Overload_set& ovl = *current_scope().lookup(name);
 
-  // Find the position of the declation within the overload
-  // set. We only need to compare it with declarations "down stream"
-  // since we will have validated all preceeding declarations.
-  auto iter = std::find_if(ovl.begin(), ovl.end(), [&decl](Decl& d) {
-    return &decl == &d;
-  });
-
-  // Check each downstream declaration in turn, trapping declaration
-  // errors so we can diagnose as many as possible.
   bool ok = true;
-  for (++iter ; iter != ovl.end(); ++iter) {
-    try {
-      check_declarations(cxt, decl, *iter);
-    } catch (...) {
-      ok = false;
-    }
-  }
+  Decl& first = ovl.front();
+  if (&first != &decl && !(is<Function_decl>(first) && is<Function_decl>(decl)))
+    ok &= check_overload(cxt, first, decl);
+  if (Decl* prev = ovl.find_signature(decl))
+    ok &= check_overload(cxt, *prev, decl);
+  ovl.index_signature(decl);
 
   // If we got an error, rethrow it.
   if (!ok)
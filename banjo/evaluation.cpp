@@ -4,6 +4,7 @@
 #include "evaluation.hpp"
 #include "ast.hpp"
 #include "builder.hpp"
+#include "parser.hpp"
 #include "printer.hpp"
 
 #include <iostream>
@@ -140,6 +141,11 @@ Evaluator::evaluate_call(Call_expr const& e)
   Value v = evaluate(e.function());
   Function_decl const& f = *v.get_function();
 
+  // The definition may not have been elaborated yet. It is unavailable
+  // while it is being elaborated by the caller.
+  if (cxt && !elaborate_definition(*cxt, const_cast<Function_decl&>(f)))
+    throw Evaluation_error("function definition is not available");
+
   // There should probably be a body for the function.
   //
   // FIXME: What if the function is = default. How do we determine
@@ -338,7 +344,7 @@ reduce(Context& cxt, Expr& e)
     Expr& operator()(Tuple_value const& v)     { lingo_unreachable(); }
 
   };
-  return apply(evaluate(e), fn{cxt, e.type()});
+  return apply(evaluate(cxt, e), fn{cxt, e.type()});
 }
 
 
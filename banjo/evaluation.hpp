@@ -47,9 +47,20 @@ enum Control
 // value.
 //
 // FIXME: 
+//
+// When given a context, the evaluator elaborates deferred function
+// definitions as they are called.
 struct Evaluator
 {
 public:
+  Evaluator()
+    : cxt(nullptr)
+  { }
+
+  Evaluator(Context& c)
+    : cxt(&c)
+  { }
+
   Value operator()(Expr const& e) { return evaluate(e); }
 
   Value evaluate(Expr const&);
@@ -78,6 +89,7 @@ public:
 
   struct Enter_frame;
 
+  Context*   cxt;
   Call_stack stack;
 };
 
@@ -112,6 +124,16 @@ evaluate(Expr const& e)
 }
 
 
+// Evaluate the given expression, elaborating the definitions of
+// called functions as needed.
+inline Value
+evaluate(Context& cxt, Expr const& e)
+{
+  Evaluator eval(cxt);
+  return eval(e);
+}
+
+
 Expr const& reduce(Context&, Expr const&);
 Expr&       reduce(Context&, Expr&);
 
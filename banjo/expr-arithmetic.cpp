@@ -23,6 +23,8 @@ namespace banjo
 Expr&
 make_add(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_add(t, e1, e2);
 }
@@ -31,6 +33,8 @@ make_add(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_sub(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_sub(t, e1, e2);
 }
@@ -39,6 +43,8 @@ make_sub(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_mul(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_mul(t, e1, e2);
 }
@@ -47,6 +53,8 @@ make_mul(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_div(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_div(t, e1, e2);
 }
@@ -55,6 +63,8 @@ make_div(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_rem(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_rem(t, e1, e2);
 }
@@ -63,6 +73,7 @@ make_rem(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_neg(Context& cxt, Expr& e)
 {
+  require_typed(cxt, e);
   Type& t = cxt.get_int_type();
   return cxt.make_neg(t, e);
 }
@@ -71,6 +82,7 @@ make_neg(Context& cxt, Expr& e)
 Expr&
 make_pos(Context& cxt, Expr& e)
 {
+  require_typed(cxt, e);
   return cxt.make_pos(e.type(), e);
 }
 
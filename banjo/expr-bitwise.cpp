@@ -23,6 +23,8 @@ namespace banjo
 Expr&
 make_bit_and(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_bit_and(t, e1, e2);
 }
@@ -31,6 +33,8 @@ make_bit_and(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_bit_or(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_bit_or(t, e1, e2);
 }
@@ -39,6 +43,8 @@ make_bit_or(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_bit_xor(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_bit_xor(t, e1, e2);
 }
@@ -47,6 +53,8 @@ make_bit_xor(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_bit_lsh(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_bit_lsh(t, e1, e2);
 }
@@ -55,6 +63,8 @@ make_bit_lsh(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_bit_rsh(Context& cxt, Expr& e1, Expr& e2)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t = cxt.get_int_type();
   return cxt.make_bit_rsh(t, e1, e2);
 }
@@ -63,6 +73,7 @@ make_bit_rsh(Context& cxt, Expr& e1, Expr& e2)
 Expr&
 make_bit_not(Context& cxt, Expr& e)
 {
+  require_typed(cxt, e);
   Type& t = cxt.get_int_type();
   return cxt.make_bit_not(t, e);
 }
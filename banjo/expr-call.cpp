@@ -10,6 +10,7 @@
 #include "template.hpp"
 #include "constraint.hpp"
 #include "lookup.hpp"
+#include "call.hpp"
 #include "deduction.hpp"
 #include "subsumption.hpp"
 #include "printer.hpp"
@@ -124,6 +125,10 @@ make_regular_call(Context& cxt, Expr& e, Expr_list& args)
     throw Translation_error(cxt, "'{}' is not callable", e);
   }
 
+  // Select one of the overloaded functions.
+  if (Overload_expr* ovl = as<Overload_expr>(&e))
+    return resolve_function_call(cxt, ovl->declarations(), args);
+
   banjo_unhandled_case(e);
 }
 
@@ -131,6 +136,11 @@ make_regular_call(Context& cxt, Expr& e, Expr_list& args)
 Expr&
 make_call(Context& cxt, Expr& e, Expr_list& args)
 {
+  // Arguments must have types. Only the target of the call may refer
+  // to overloaded functions.
+  for (Expr& a : args)
+    require_typed(cxt, a);
+
   // if (is_type_dependent(e) || is_type_dependent(args))
   //   return make_dependent_call(cxt, e, args);
   // else
@@ -6,6 +6,7 @@
 #include "template.hpp"
 #include "context.hpp"
 #include "lookup.hpp"
+#include "parser.hpp"
 #include "printer.hpp"
 
 #include <iostream>
@@ -22,6 +23,9 @@ namespace banjo
 Expr&
 make_reference(Context& cxt, Decl& d)
 {
+  // The type of the declaration is needed to form the reference.
+  require_declaration(cxt, d);
+
   // TODO: What other kinds of objects do we have here...
   //
   // TODO: Dispatch.
@@ -58,12 +62,15 @@ make_reference(Context& cxt, Decl& d)
 Expr&
 make_reference(Context& cxt, Simple_id& id)
 {
-  Decl_list decls = unqualified_lookup(cxt, id);
+  Overload_set& decls = unqualified_lookup(cxt, id);
   if (decls.size() == 1)
     return make_reference(cxt, decls.front());
 
-  // TODO: Return a reference to an overload set.
-  banjo_unhandled_case(id);
+  // The types of the overloaded functions are needed to resolve
+  // calls to them.
+  for (Decl& d : decls)
+    require_declaration(cxt, d);
+  return cxt.make_reference(decls);
 }
 
 
@@ -158,6 +165,7 @@ make_member_reference(Context& cxt, Expr& obj, Decl& decl)
 Expr&
 make_member_reference(Context& cxt, Expr& obj, Simple_id& name)
 {
+  require_typed(cxt, obj);
   Type& type = obj.type();
   Decl_list decls = qualified_lookup(cxt, type, name);
   if (decls.size() == 1)
@@ -77,6 +77,7 @@ template<typename Make>
 static Expr&
 make_logical_expr(Context& cxt, Expr& e, Make make)
 {
+  require_typed(cxt, e);
   Type& t = e.type();
   try {
     if (is_dependent_type(t))
@@ -163,6 +164,8 @@ template<typename Make>
 static Expr&
 make_logical_expr(Context& cxt, Expr& e1, Expr& e2, Make make)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t1 = e1.type();
   Type& t2 = e2.type();
   try {
@@ -202,6 +205,7 @@ Expr&
 make_logical_not(Context& cxt, Expr& e)
 {
   Builder build(cxt);
+  require_typed(cxt, e);
   Expr& c = contextual_conversion_to_bool(cxt, e);
   Type& t = c.type();
   return build.make_not(t, c);
@@ -24,7 +24,7 @@ template<typename Make>
 static Expr&
 make_standard_relational_expr(Context& cxt, Expr& e1, Expr& e2, Make make)
 {
-  Expr_pair conv = arithmetic_conversion(e1, e2);
+  Expr_pair conv = arithmetic_conversion(cxt, e1, e2);
   Type& t = e1.type();
   return make(t, conv.first, conv.second);
 }
@@ -81,6 +81,8 @@ template<typename Make>
 static Expr&
 make_relational_expr(Context& cxt, Expr& e1, Expr& e2, Make make)
 {
+  require_typed(cxt, e1);
+  require_typed(cxt, e2);
   Type& t1 = e1.type();
   Type& t2 = e2.type();
   try {
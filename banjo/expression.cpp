@@ -5,6 +5,7 @@
 #include "ast-expr.hpp"
 #include "context.hpp"
 #include "lookup.hpp"
+#include "printer.hpp"
 
 
 namespace banjo
@@ -22,6 +23,17 @@ make_required_expression(Context& cxt, Expr& e)
 }
 
 
+// Diagnose the use of an expression that has no type. Only a reference
+// to a set of overloaded functions has no type, and such a reference can
+// only be called. Its type is determined by overload resolution.
+void
+require_typed(Context& cxt, Expr const& e)
+{
+  if (!e.is_typed())
+    throw Type_error(cxt, "overloaded function '{}' used outside a call", e);
+}
+
+
 // A requires expression has type bool.
 //
 // TODO: Actually validate information about the requires expression. The
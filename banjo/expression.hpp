@@ -15,6 +15,8 @@ struct Context;
 
 Expr& make_required_expression(Context&, Expr&);
 
+void require_typed(Context&, Expr const&);
+
 Expr& make_logical_and(Context&, Expr&, Expr&);
 Expr& make_logical_or(Context&, Expr&, Expr&);
 Expr& make_logical_not(Context&, Expr&);
@@ -0,0 +1,112 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "factory.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+
+namespace banjo
+{
+
+constexpr std::size_t Unique_terms::name_hint;
+constexpr std::size_t Unique_terms::type_hint;
+constexpr std::size_t Unique_terms::cons_hint;
+
+
+Unique_terms::Unique_terms()
+{
+  simple_ids.reserve(name_hint);
+  reserve(type_hint, cons_hint);
+}
+
+
+// Reserve space in the type and constraint tables for at least
+// the given number of terms of each kind.
+void
+Unique_terms::reserve(std::size_t t, std::size_t c)
+{
+  int_types.reserve(t);
+  user_types.reserve(t);
+  typename_types.reserve(t);
+  fn_types.reserve(t);
+  qual_types.reserve(t);
+  ptr_types.reserve(t);
+  ref_types.reserve(t);
+
+  concept_cons.reserve(c);
+  predicate_cons.reserve(c);
+  expression_cons.reserve(c);
+  conversion_cons.reserve(c);
+  parameterized_cons.reserve(c);
+  conjunction_cons.reserve(c);
+  disjunction_cons.reserve(c);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Statistics
+
+namespace
+{
+
+template<typename T, typename H, typename E>
+void
+print_table(std::ostream& os, char const* name, Hashed_unique_factory<T, H, E> const& f)
+{
+  os << std::left << std::setw(20) << name << std::right
+     << std::setw(10) << f.size()
+     << std::setw(10) << f.hits
+     << std::setw(10) << f.misses
+     << std::setw(10) << std::fixed << std::setprecision(2) << f.load_factor()
+     << '\n';
+}
+
+
+} // namespace
+
+
+// Print the size, hits, misses, and load factor of each table.
+void
+print_statistics(std::ostream& os, Unique_terms const& u)
+{
+  os << std::left << std::setw(20) << "table" << std::right
+     << std::setw(10) << "size"
+     << std::setw(10) << "hits"
+     << std::setw(10) << "misses"
+     << std::setw(10) << "load"
+     << '\n';
+  print_table(os, "simple-id", u.simple_ids);
+  print_table(os, "operator-id", u.operator_ids);
+  print_table(os, "placeholder-id", u.placeholder_ids);
+  print_table(os, "global-id", u.global_ids);
+  print_table(os, "void", u.void_types);
+  print_table(os, "bool", u.bool_types);
+  print_table(os, "byte", u.byte_types);
+  print_table(os, "integer", u.int_types);
+  print_table(os, "float", u.float_types);
+  print_table(os, "user", u.user_types);
+  print_table(os, "typename", u.typename_types);
+  print_table(os, "function", u.fn_types);
+  print_table(os, "qualified", u.qual_types);
+  print_table(os, "pointer", u.ptr_types);
+  print_table(os, "reference", u.ref_types);
+  print_table(os, "slice", u.slice_types);
+  print_table(os, "in", u.in_types);
+  print_table(os, "out", u.out_types);
+  print_table(os, "mutable", u.mutable_types);
+  print_table(os, "consume", u.consume_types);
+  print_table(os, "forward", u.forward_types);
+  print_table(os, "pack", u.pack_types);
+  print_table(os, "concept-cons", u.concept_cons);
+  print_table(os, "predicate-cons", u.predicate_cons);
+  print_table(os, "expression-cons", u.expression_cons);
+  print_table(os, "conversion-cons", u.conversion_cons);
+  print_table(os, "parameterized-cons", u.parameterized_cons);
+  print_table(os, "conjunction-cons", u.conjunction_cons);
+  print_table(os, "disjunction-cons", u.disjunction_cons);
+}
+
+
+} // namespace banjo
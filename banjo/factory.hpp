@@ -0,0 +1,315 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_FACTORY_HPP
+#define BANJO_FACTORY_HPP
+
+// This module defines the facilities used to unique (hash-cons) terms
+// within a context.
+
+#include "ast.hpp"
+#include "ast-hash.hpp"
+#include "ast-eq.hpp"
+
+#include <iosfwd>
+#include <unordered_set>
+
+
+namespace banjo
+{
+
+// FIXME: Move this into lingo.
+//
+// A unique factory will only allocate new objects if they have not been
+// previously created. The factory records the number of requests that
+// found an existing object (hits) and that created a new one (misses).
+template<typename T, typename Hash, typename Eq>
+struct Hashed_unique_factory : std::unordered_set<T, Hash, Eq>
+{
+  // Returns the unique object equivalent to T(args...). The key is
+  // constructed on the stack and only copied into the table when no
+  // such object exists.
+  template<typename... Args>
+  T& make(Args&&... args)
+  {
+    T key(std::forward<Args>(args)...);
+    init_kind(key);
+    auto iter = this->find(key);
+    if (iter == this->end()) {
+      iter = this->insert(std::move(key)).first;
+      ++misses;
+    } else {
+      ++hits;
+    }
+    return *const_cast<T*>(&*iter); // Yuck.
+  }
+
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+};
+
+
+template<typename T>
+struct Hash
+{
+  std::size_t operator()(T const& t) const
+  {
+    return hash_value(t);
+  }
+
+  std::size_t operator()(List<T> const& t) const
+  {
+    return hash_value(t);
+  }
+};
+
+
+template<typename T>
+struct Eq
+{
+  bool operator()(T const& a, T const& b) const
+  {
+    return is_equivalent(a, b);
+  }
+
+  bool operator()(List<T> const& a, List<T> const& b) const
+  {
+    return is_equivalent(a, b);
+  }
+};
+
+
+template<typename T>
+using Factory = Hashed_unique_factory<T, Hash<T>, Eq<T>>;
+
+
+// -------------------------------------------------------------------------- //
+// Unique names
+//
+// Simple, operator, placeholder, and global identifiers are unique
+// within a context. Names of each kind are hashed and compared by
+// their symbol, operator, or number.
+
+struct Name_key_hash
+{
+  std::size_t operator()(Name const&) const
+  {
+    return 0;
+  }
+
+  std::size_t operator()(Simple_id const& n) const
+  {
+    Hasher h;
+    h.add(&n.symbol());
+    return h.value();
+  }
+
+  std::size_t operator()(Placeholder_id const& n) const
+  {
+    Hasher h(n.number());
+    return h.value();
+  }
+
+  std::size_t operator()(Operator_id const& n) const
+  {
+    Hasher h(n.kind());
+    return h.value();
+  }
+};
+
+
+struct Name_key_eq
+{
+  bool operator()(Name const&, Name const&) const
+  {
+    return true;
+  }
+
+  bool operator()(Simple_id const& a, Simple_id const& b) const
+  {
+    return &a.symbol() == &b.symbol();
+  }
+
+  bool operator()(Placeholder_id const& a, Placeholder_id const& b) const
+  {
+    return a.number() == b.number();
+  }
+
+  bool operator()(Operator_id const& a, Operator_id const& b) const
+  {
+    return a.kind() == b.kind();
+  }
+};
+
+
+template<typename T>
+using Name_factory = Hashed_unique_factory<T, Name_key_hash, Name_key_eq>;
+
+
+// -------------------------------------------------------------------------- //
+// Canonical types
+//
+// The components of a canonical type are themselves canonical. Two
+// canonical types are the same when they have the same kind and their
+// components are identical, so types are hashed and compared by the
+// identity of their components and not by structural equivalence.
+
+struct Type_key_hash
+{
+  std::size_t operator()(Type const&) const
+  {
+    return 0;
+  }
+
+  std::size_t operator()(Integer_type const& t) const
+  {
+    Hasher h(t.sign());
+    h.add(t.precision());
+    return h.value();
+  }
+
+  std::size_t operator()(Float_type const& t) const
+  {
+    Hasher h(t.precision());
+    return h.value();
+  }
+
+  std::size_t operator()(User_type const& t) const
+  {
+    Hasher h;
+    h.add(t.decl_);
+    return h.value();
+  }
+
+  std::size_t operator()(Function_type const& t) const
+  {
+    Hasher h(t.parameter_types().size());
+    for (Type const& p : t.parameter_types())
+      h.add(&p);
+    h.add(&t.return_type());
+    return h.value();
+  }
+
+  std::size_t operator()(Unary_type const& t) const
+  {
+    Hasher h;
+    h.add(&t.type());
+    return h.value();
+  }
+
+  std::size_t operator()(Qualified_type const& t) const
+  {
+    Hasher h(t.qualifier());
+    h.add(&t.type());
+    return h.value();
+  }
+};
+
+
+struct Type_key_eq
+{
+  bool operator()(Type const&, Type const&) const
+  {
+    return true;
+  }
+
+  bool operator()(Integer_type const& a, Integer_type const& b) const
+  {
+    return a.sign() == b.sign() && a.precision() == b.precision();
+  }
+
+  bool operator()(Float_type const& a, Float_type const& b) const
+  {
+    return a.precision() == b.precision();
+  }
+
+  bool operator()(User_type const& a, User_type const& b) const
+  {
+    return a.decl_ == b.decl_;
+  }
+
+  bool operator()(Function_type const& a, Function_type const& b) const
+  {
+    return &a.return_type() == &b.return_type()
+        && a.parameter_types().base() == b.parameter_types().base();
+  }
+
+  bool operator()(Unary_type const& a, Unary_type const& b) const
+  {
+    return &a.type() == &b.type();
+  }
+
+  bool operator()(Qualified_type const& a, Qualified_type const& b) const
+  {
+    return a.qualifier() == b.qualifier() && &a.type() == &b.type();
+  }
+};
+
+
+template<typename T>
+using Type_factory = Hashed_unique_factory<T, Type_key_hash, Type_key_eq>;
+
+
+// -------------------------------------------------------------------------- //
+// Unique terms
+
+// The tables of unique terms owned by a context. These are released
+// with the context, so independent contexts share no state.
+//
+// Note that placeholder types (auto and decltype(auto)) and synthetic
+// types are never uniqued; each is distinct from every other.
+struct Unique_terms
+{
+  // Default reservation hints for the name, type, and constraint tables.
+  static constexpr std::size_t name_hint = 256;
+  static constexpr std::size_t type_hint = 64;
+  static constexpr std::size_t cons_hint = 32;
+
+  Unique_terms();
+
+  void reserve(std::size_t, std::size_t);
+
+  // Names
+  Name_factory<Simple_id>      simple_ids;
+  Name_factory<Operator_id>    operator_ids;
+  Name_factory<Placeholder_id> placeholder_ids;
+  Name_factory<Global_id>      global_ids;
+
+  // Types
+  Type_factory<Void_type>      void_types;
+  Type_factory<Boolean_type>   bool_types;
+  Type_factory<Byte_type>      byte_types;
+  Type_factory<Integer_type>   int_types;
+  Type_factory<Float_type>     float_types;
+  Type_factory<User_type>      user_types;
+  Type_factory<Typename_type>  typename_types;
+  Type_factory<Function_type>  fn_types;
+  Type_factory<Qualified_type> qual_types;
+  Type_factory<Pointer_type>   ptr_types;
+  Type_factory<Reference_type> ref_types;
+  Type_factory<Slice_type>     slice_types;
+  Type_factory<In_type>        in_types;
+  Type_factory<Out_type>       out_types;
+  Type_factory<Mutable_type>   mutable_types;
+  Type_factory<Consume_type>   consume_types;
+  Type_factory<Forward_type>   forward_types;
+  Type_factory<Pack_type>      pack_types;
+
+  // Constraints
+  Factory<Concept_cons>       concept_cons;
+  Factory<Predicate_cons>     predicate_cons;
+  Factory<Expression_cons>    expression_cons;
+  Factory<Conversion_cons>    conversion_cons;
+  Factory<Parameterized_cons> parameterized_cons;
+  Factory<Conjunction_cons>   conjunction_cons;
+  Factory<Disjunction_cons>   disjunction_cons;
+};
+
+
+void print_statistics(std::ostream&, Unique_terms const&);
+
+
+} // namespace banjo
+
+
+#endif
@@ -15,6 +15,7 @@
 #include <llvm/Support/raw_ostream.h>
 
 #include <iostream>
+#include <unistd.h>
 
 
 namespace banjo
@@ -635,7 +636,7 @@ Generator::gen(Promote_conv const* e)
   const Type * t = e->target();
 
   if(is<Integer_type>(t)) {
-    const Integer_type * t2 = dynamic_cast<const Integer_type*>(t);
+    const Integer_type * t2 = cast<Integer_type>(t);
     return build.CreateIntCast(v, get_type(t2), t2->is_signed());
   }
   else if (is<Float_type>(t) || is<Double_type>(t)) {
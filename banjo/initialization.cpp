@@ -6,6 +6,7 @@
 #include "ast-expr.hpp"
 #include "conversion.hpp"
 #include "inheritance.hpp"
+#include "expression.hpp"
 #include "builder.hpp"
 #include "printer.hpp"
 
@@ -117,6 +118,9 @@ copy_initialize(Context& cxt, Type& t, Expr& e)
 {
   Builder build(cxt);
 
+  // The initializer must have a type.
+  require_typed(cxt, e);
+
   // If the destination type is a T&, then perform reference
   // initialization.
   if (is_reference_type(t))
@@ -151,11 +155,37 @@ copy_initialize(Context& cxt, Type& t, Expr& e)
   //
   // TODO: Catch exceptions and restructure the error with
   // the conversion error as an explanation.
-  Expr& c = standard_conversion(e, t);
+  Expr& c = standard_conversion(cxt, e, t);
   return build.make_copy_init(t, c);
 }
 
 
+// Determine if an object or reference of type `t` can be copy
+// initialized by `e`, without building the initialization. This
+// follows the same steps as copy_initialize.
+Init_probe
+probe_copy_initialize(Context& cxt, Type& t, Expr& e)
+{
+  require_typed(cxt, e);
+
+  if (is_reference_type(t))
+    return probe_reference_initialize(cxt, cast<Reference_type>(t), e);
+
+  if (is_dependent_type(t))
+    return {probe_dependent_conversion(cxt, e, t), conversion_rank};
+
+  if (is_array_type(t))
+    banjo_unhandled_case(t);
+
+  Type& s = e.type();
+  if (is_dependent_type(s))
+    return {probe_dependent_conversion(cxt, e, t), conversion_rank};
+
+  Conversion_recipe const& r = probe_standard_conversion(cxt, s, t);
+  return {r.ok, r.rank};
+}
+
+
 // Select a procedure to direct-initialize an object or reference of
 // type `t` by a paren-enclosed list of expressions `es`. This corresponds
 // to the initialization of a variable by the syntax:
@@ -180,6 +210,7 @@ direct_initialize(Context& cxt, Type& t, Expr_list& es)
     return value_initialize(cxt, t);
 
   Expr& e = es.front();
+  require_typed(cxt, e);
 
   // If the destination type is a T&, then perform reference
   // initialization on the only element in the list of expressions.
@@ -214,7 +245,7 @@ direct_initialize(Context& cxt, Type& t, Expr_list& es)
   //
   // TODO: Catch exceptions and restructure the error with
   // the conversion error as an explanation.
-  Expr& c = standard_conversion(e, t);
+  Expr& c = standard_conversion(cxt, e, t);
   return cxt.make_copy_init(t, c);
 }
 
@@ -299,6 +330,7 @@ is_reference_compatible(Type const& t1, Type const& t2)
 Expr&
 reference_initialize(Context& cxt, Reference_type& t1, Expr& e)
 {
+  require_typed(cxt, e);
   Type& r1 = t1.non_reference_type();
 
   // The initializer has reference type.
@@ -329,6 +361,21 @@ reference_initialize(Context& cxt, Reference_type& t1, Expr& e)
 }
 
 
+// Determine if the reference type `t1` can be bound to `e`. This
+// follows the same steps as reference_initialize.
+Init_probe
+probe_reference_initialize(Context& cxt, Reference_type& t1, Expr& e)
+{
+  require_typed(cxt, e);
+  Type& t2 = e.type();
+  if (is_reference_type(t2)) {
+    if (is_reference_compatible(t1.non_reference_type(), t2.non_reference_type()))
+      return {true, exact_rank};
+  }
+  return {false, exact_rank};
+}
+
+
 // -------------------------------------------------------------------------- //
 // Aggregate initialization
 
@@ -5,10 +5,23 @@
 #define BANJO_INITIALIZATION_HPP
 
 #include "ast-base.hpp"
+#include "conversion.hpp"
 
 namespace banjo
 {
 
+// The result of checking an initialization without performing it.
+// If the initialization is viable, rank is the rank of the worst
+// conversion it requires.
+struct Init_probe
+{
+  explicit operator bool() const { return viable; }
+
+  bool            viable;
+  Conversion_rank rank;
+};
+
+
 Expr& zero_initialize(Context&, Type&);
 Expr& default_initialize(Context&, Type&);
 Expr& value_initialize(Context&, Type&);
@@ -19,6 +32,9 @@ Expr& list_initialize(Context&, Type&, Expr_list&);
 Expr& reference_initialize(Context&, Reference_type&, Expr&);
 Expr& aggregate_initialize(Context&, Type&, Expr_list&);
 
+Init_probe probe_copy_initialize(Context&, Type&, Expr&);
+Init_probe probe_reference_initialize(Context&, Reference_type&, Expr&);
+
 
 } // namespace banjo
 
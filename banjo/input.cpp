@@ -0,0 +1,91 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "input.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace banjo
+{
+
+namespace
+{
+
+// Read the remaining contents of the file descriptor into a new buffer.
+// Returns the past-the-end position of the buffer in last.
+char*
+read_file(int fd, char const*& last)
+{
+  std::size_t cap = 4096;
+  std::size_t n = 0;
+  char* buf = new char[cap];
+  while (true) {
+    if (n == cap) {
+      char* p = new char[2 * cap];
+      std::memcpy(p, buf, n);
+      delete[] buf;
+      buf = p;
+      cap *= 2;
+    }
+    ssize_t k = ::read(fd, buf + n, cap - n);
+    if (k < 0) {
+      delete[] buf;
+      return nullptr;
+    }
+    if (k == 0)
+      break;
+    n += k;
+  }
+  last = buf + n;
+  return buf;
+}
+
+
+} // namespace
+
+
+// Map the file at the given path.
+Mapped_file::Mapped_file(String const& p)
+  : path_(p), first_(nullptr), last_(nullptr), mapped_(false)
+{
+  int fd = ::open(p.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw Compiler_error("cannot open '{}'", p);
+
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+      first_ = static_cast<char const*>(addr);
+      last_ = first_ + st.st_size;
+      mapped_ = true;
+    }
+  }
+
+  if (!mapped_) {
+    first_ = read_file(fd, last_);
+    if (!first_) {
+      ::close(fd);
+      throw Compiler_error("cannot read '{}'", p);
+    }
+  }
+
+  ::close(fd);
+}
+
+
+Mapped_file::~Mapped_file()
+{
+  if (mapped_)
+    ::munmap(const_cast<char*>(first_), size());
+  else
+    delete[] first_;
+}
+
+
+} // namespace banjo
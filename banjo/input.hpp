@@ -0,0 +1,116 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_INPUT_HPP
+#define BANJO_INPUT_HPP
+
+// This module defines facilities for reading source input without
+// copying it.
+//
+// A mapped file exposes the contents of a file as a contiguous range of
+// characters backed by the virtual memory system. The lexer scans that
+// range directly, and identifiers are interned from slices of it.
+
+#include "prelude.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+
+namespace banjo
+{
+
+// -------------------------------------------------------------------------- //
+// Mapped files
+
+// A read-only view of the contents of a file. When the file cannot be
+// mapped (e.g., it is empty or is not a regular file), its contents are
+// read into a buffer instead.
+//
+// Note that a mapped file must outlive any symbols or tokens whose
+// spellings refer to its contents. Symbols own their spellings, so
+// only the lexer refers to the mapping.
+struct Mapped_file
+{
+  explicit Mapped_file(String const&);
+  ~Mapped_file();
+
+  // Non-copyable
+  Mapped_file(Mapped_file const&) = delete;
+  Mapped_file& operator=(Mapped_file const&) = delete;
+
+  String const& path() const { return path_; }
+
+  char const* begin() const { return first_; }
+  char const* end() const   { return last_; }
+  std::size_t size() const  { return last_ - first_; }
+
+  bool is_mapped() const { return mapped_; }
+
+  String      path_;
+  char const* first_;
+  char const* last_;
+  bool        mapped_;
+};
+
+
+// -------------------------------------------------------------------------- //
+// Slices
+
+// A contiguous sequence of characters in some input.
+struct Slice
+{
+  Slice(char const* f, char const* l)
+    : first(f), len(l - f)
+  { }
+
+  Slice(String const& s)
+    : first(s.data()), len(s.size())
+  { }
+
+  char const* begin() const { return first; }
+  char const* end() const   { return first + len; }
+  std::size_t size() const  { return len; }
+
+  String str() const { return String(first, len); }
+
+  char const* first;
+  std::size_t len;
+};
+
+
+// An FNV-1a hash over the characters of a slice.
+struct Slice_hash
+{
+  std::size_t operator()(Slice s) const
+  {
+    std::size_t h = 0xcbf29ce484222325ull;
+    for (char c : s) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100000001b3ull;
+    }
+    return h;
+  }
+};
+
+
+struct Slice_eq
+{
+  bool operator()(Slice a, Slice b) const
+  {
+    return a.len == b.len && std::memcmp(a.first, b.first, a.len) == 0;
+  }
+};
+
+
+// Maps spellings to their symbols. This is used by the lexer to find
+// the symbol for a sequence of input characters without first copying
+// those characters into a string. Keys refer to the spelling of the
+// symbol, which lives as long as the symbol table.
+using Spelling_map = std::unordered_map<Slice, Symbol const*, Slice_hash, Slice_eq>;
+
+
+} // namespace banjo
+
+
+#endif
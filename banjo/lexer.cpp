@@ -4,6 +4,7 @@
 #include "lexer.hpp"
 #include "token.hpp"
 #include "context.hpp"
+#include "scan.hpp"
 
 #include "lingo/error.hpp"
 
@@ -15,36 +16,55 @@
 namespace banjo
 {
 
-Symbol_table&
-Lexer::symbols()
+// Construct a lexer for the characters in [first, last), which are the
+// contents of the input registered with buf as in.
+Lexer::Lexer(Context& cxt, int in, char const* first, char const* last, Token_buffer& buf)
+  : cxt_(cxt), first_(first), cur_(first), last_(last), tok_(first)
+  , buf_(buf), input_(in)
+  , cache_(&cxt.spellings()), lock_(nullptr)
 {
-  return cxt_.symbols();
+  if (std::size_t(last - first) > Token_buffer::max_offset)
+    throw Limitation_error("input is too large");
 }
 
 
-// Copy the current character into the save buffer.
-void
-Lexer::get()
+Symbol_table&
+Lexer::symbols()
 {
-  buf_.put(cs_.get());
+  return cxt_.symbols();
 }
 
 
-char
-Lexer::lookahead() const
+// Returns the location of the current token for a diagnostic. This is
+// created in the same way as the locations of buffered tokens (see
+// Token_buffer).
+Location
+Lexer::location() const
 {
-  return cs_.peek();
+  return buf_.source_location(input_, tok_ - first_);
 }
 
 
-// Lexically analyze a single token.
-Token
+// Lexically analyze a single token, returning its symbol. Returns
+// nullptr at the end of input.
+Symbol const*
 Lexer::scan()
 {
-  while (!cs_.eof()) {
+  while (!at_end()) {
     space();
 
-    loc_ = cs_.location();
+    tok_ = cur_;
+
+    // Words and integers are recognized by the class of their first
+    // character. A word begins with any identifier character that is
+    // not a digit (i.e., a letter or an underscore). Punctuators are
+    // recognized by the switch below.
+    unsigned cls = char_class(lookahead());
+    if (cls & digit_char)
+      return integer();
+    if (cls & ident_char)
+      return word();
+
     switch (lookahead()) {
     case '\0': return eof();
 
@@ -140,58 +160,97 @@ Lexer::scan()
       return symbol();
 
     default:
-      // FIXME: Handle underscores in identifiers.
-      if (is_alpha(lookahead())) {
-        return word();
-      } else if (is_decimal_digit(lookahead())) {
-        return integer();
-      } else {
-        error();
-        continue;
-      }
+      error();
+      continue;
     }
   }
-  return {};
+  return nullptr;
 }
 
 
 void
 Lexer::error()
 {
-  lingo::error(loc_, "unrecognized character '{}'", cs_.get());
+  std::unique_lock<std::mutex> guard;
+  if (lock_)
+    guard = std::unique_lock<std::mutex>(*lock_);
+  lingo::error(location(), "unrecognized character '{}'", lookahead());
+  get();
+}
+
+
+// Match the brace of kind k, which is the last token in the buffer.
+// Opening braces are saved until their closing brace is found.
+void
+Lexer::brace(Token_kind k)
+{
+  Token_buffer::Index n = buf_.size() - 1;
+  if (is_open_brace(k)) {
+    braces_.push_back(n);
+    return;
+  }
+
+  std::unique_lock<std::mutex> guard;
+  if (lock_)
+    guard = std::unique_lock<std::mutex>(*lock_);
+  if (braces_.empty()) {
+    lingo::error(location(), "unmatched brace '{}'", get_spelling(k));
+    return;
+  }
+  Token_buffer::Index m = braces_.back();
+  braces_.pop_back();
+  Token_kind open = Token_kind(buf_.kind(m));
+  if (get_closing_brace(open) != k) {
+    lingo::error(location(), "unbalanced brace '{}'", get_spelling(k));
+    lingo::note(buf_.source_location(m), "does not match '{}'", get_spelling(open));
+    return;
+  }
+  buf_.match(m, n);
 }
 
 
+// Diagnose opening braces that have no closing brace.
+void
+Lexer::unmatched_braces()
+{
+  std::unique_lock<std::mutex> guard;
+  if (lock_)
+    guard = std::unique_lock<std::mutex>(*lock_);
+  for (Token_buffer::Index n : braces_) {
+    Token_kind k = Token_kind(buf_.kind(n));
+    lingo::error(buf_.source_location(n), "unmatched brace '{}'", get_spelling(k));
+  }
+  braces_.clear();
+}
+
+
+// Consume a run of whitespace.
 void
 Lexer::space()
 {
-  while (is_space(cs_.peek()))
-    cs_.ignore();
+  cur_ = skip_space(cur_, last_);
 }
 
 
-// Consume all characters through the end of line. Clear the character
-// cache before continuing.
+// Consume all characters through the end of line.
 void
 Lexer::comment()
 {
-  while (lookahead() != '\n')
-    cs_.ignore();
-  buf_.clear();
+  cur_ = find_newline(cur_, last_);
 }
 
 
-Token
+Symbol const*
 Lexer::eof()
 {
-  return Token{};
+  return nullptr;
 }
 
 
-Token
+Symbol const*
 Lexer::symbol()
 {
-  // Nothing to do here... we've already buffered all of
+  // Nothing to do here... we've already consumed all of
   // the characters for the symbol.
   return on_symbol();
 }
@@ -201,86 +260,144 @@ Lexer::symbol()
 void
 Lexer::digit()
 {
-  assert(is_decimal_digit(cs_.peek()));
+  assert(char_class(lookahead()) & digit_char);
   get();
 }
 
 
-// letter ::= [a-z][A-Z]
-//
-// FIXME: Make this handle identifiers.
+// letter ::= [a-z][A-Z]_
 void
 Lexer::letter()
 {
-  assert(is_alpha(cs_.peek()));
+  assert((char_class(lookahead()) & (ident_char | digit_char)) == ident_char);
   get();
 }
 
 
-inline bool
-is_identifier_alpha(char c)
-{
-  return is_alpha(c) || is_decimal_digit(c) || c == '_';
-}
-
-
-Token
+Symbol const*
 Lexer::word()
 {
   letter();
-  while (is_identifier_alpha(lookahead()))
+  while (is_ident_char(lookahead()))
     get();
   return on_word();
 }
 
 
 // FIXME: Rewrite this to handle general numbers.
-Token
+Symbol const*
 Lexer::integer()
 {
   digit();
-  while (is_decimal_digit(cs_.peek()))
+  while (char_class(lookahead()) & digit_char)
     digit();
   return on_integer();
 }
 
 
-Token
+// Returns the symbol previously lexed with the spelling of the current
+// token, or nullptr if there is none.
+inline Symbol const*
+find_spelling(Spelling_map& map, Slice s)
+{
+  auto iter = map.find(s);
+  if (iter != map.end())
+    return iter->second;
+  return nullptr;
+}
+
+
+// Associate the spelling of a symbol with that symbol. The key refers
+// to the symbol's own spelling, not the input.
+inline Symbol const*
+save_spelling(Spelling_map& map, Symbol const* sym)
+{
+  map.emplace(Slice(sym->spelling()), sym);
+  return sym;
+}
+
+
+// Returns the symbol for the spelling of the current token. If the
+// spelling has not been seen before, make() is called to find or create
+// the symbol in the symbol table.
+//
+// When lexing in parallel, the lexer's own spelling cache is searched
+// first. The shared cache and the symbol table are only accessed while
+// holding the symbol table lock.
+template<typename F>
+Symbol const*
+Lexer::intern(F make)
+{
+  Slice str = spelling();
+  if (Symbol const* sym = find_spelling(*cache_, str))
+    return sym;
+
+  std::unique_lock<std::mutex> guard;
+  if (lock_)
+    guard = std::unique_lock<std::mutex>(*lock_);
+  Spelling_map& shared = cxt_.spellings();
+  Symbol const* sym = find_spelling(shared, str);
+  if (!sym) {
+    sym = make();
+    if (!sym)
+      return nullptr;
+    save_spelling(shared, sym);
+  }
+  if (cache_ != &shared)
+    save_spelling(*cache_, sym);
+  return sym;
+}
+
+
+Symbol const*
 Lexer::on_symbol()
 {
-  Symbol const* sym = symbols().get(buf_.take());
-  return Token(loc_, sym);
+  return intern([this]() {
+    return symbols().get(spelling().str());
+  });
 }
 
 
-// Try looking up the symbol first. If there is no such
-// symbol, then this must be an identifier.
-Token
+// Keywords are recognized without consulting the symbol table. Other
+// words are identifiers.
+Symbol const*
 Lexer::on_word()
 {
-  String str = buf_.take();
-  Symbol const* sym = symbols().get(str);
-  if (!sym)
-    sym = symbols().put_identifier(identifier_tok, str);
-  return Token(loc_, sym);
+  Token_kind k = lookup_keyword(tok_, cur_);
+  if (k != identifier_tok)
+    return cxt_.keyword_symbol(k);
+
+  return intern([this]() -> Symbol const* {
+    String str = spelling().str();
+    if (Symbol const* sym = symbols().get(str))
+      return sym;
+    return symbols().put_identifier(identifier_tok, str);
+  });
 }
 
 
-Token
+Symbol const*
 Lexer::on_integer()
 {
-  String str = buf_.take();
-  int n = string_to_int<int>(str, 10);
-  Symbol* sym = symbols().put_integer(integer_tok, str, n);
-  return Token(loc_, sym);
+  return intern([this]() {
+    String str = spelling().str();
+    int n = string_to_int<int>(str, 10);
+    return symbols().put_integer(integer_tok, str, n);
+  });
 }
 
 
 void
 Lexer::operator()()
 {
-  while (Token tok = scan())
-    ts_.put(tok);
+  while (Symbol const* sym = scan()) {
+    buf_.put(input_, tok_ - first_, *sym);
+    Token_kind k = Token_kind(sym->token());
+    if (is_open_brace(k) || is_close_brace(k))
+      brace(k);
+  }
+  if (!braces_.empty())
+    unmatched_braces();
 }
 
 
@@ -5,10 +5,16 @@
 #define BANJO_LEXER_HPP
 
 #include "prelude.hpp"
+#include "input.hpp"
+#include "token.hpp"
+#include "token-buffer.hpp"
 
 #include <lingo/symbol.hpp>
 #include <lingo/token.hpp>
 #include <lingo/character.hpp>
+#include <lingo/file.hpp>
+
+#include <mutex>
 
 
 namespace banjo
@@ -21,49 +27,131 @@ struct Context;
 // characters into tokens. This is primarily a callback
 // interface for the lexing function for the language.
 //
+// Tokens are appended to a token buffer. The lexer registers its
+// input with that buffer, and each token records the symbol and the
+// offset of its spelling within the input. The lexer also matches
+// braces, recording the matches in the buffer, and diagnoses braces
+// that are unmatched or unbalanced.
+//
+// The lexer scans a contiguous range of characters directly; it
+// does not buffer the characters of a token. The spelling of each
+// token is the slice of the input between the start of the token and
+// the current position. Symbols are found by that slice, and a string
+// is only created for spellings that have not been seen before.
+//
+// Several lexers may run concurrently on the same context (see share()).
+// Each has its own spelling cache, and accesses to the symbol table are
+// serialized by a lock.
+//
 // TODO: Make this take a context instead of just the symbol
 // table? That would allow us to pass configuration information
 // and diagnostics into the lexer.
 struct Lexer
 {
-  Lexer(Context& cxt, Character_stream& cs, Token_stream& ts)
-    : cxt_(cxt), cs_(cs), ts_(ts)
+  Lexer(Context& cxt, File& f, Token_buffer& buf)
+    : Lexer(cxt, buf.add_input(&f), f.begin(), f.end(), buf)
   { }
 
+  Lexer(Context& cxt, Mapped_file const& f, Token_buffer& buf)
+    : Lexer(cxt, buf.add_input(f.path()), f.begin(), f.end(), buf)
+  { }
+
+  Lexer(Context&, int, char const*, char const*, Token_buffer&);
+
+  void share(Spelling_map&, std::mutex&);
+
   void operator()();
 
   // Scanners
-  Token scan();
-  Token eof();
-  Token symbol();
-  Token word();
-  Token integer();
+  Symbol const* scan();
+  Symbol const* eof();
+  Symbol const* symbol();
+  Symbol const* word();
+  Symbol const* integer();
 
   // Consumers
   void error();
+  void brace(Token_kind);
+  void unmatched_braces();
   void space();
   void comment();
   void letter();
   void digit();
 
   // Semantic actions.
-  Token on_symbol();
-  Token on_word();
-  Token on_integer();
+  Symbol const* on_symbol();
+  Symbol const* on_word();
+  Symbol const* on_integer();
 
+  bool at_end() const;
   char lookahead() const;
   void get();
 
+  Slice spelling() const;
+  Location location() const;
+
+  template<typename F>
+  Symbol const* intern(F);
+
   Symbol_table& symbols();
 
-  Context&          cxt_;
-  Character_stream& cs_;
-  Token_stream&     ts_;
-  String_builder    buf_;
-  Location          loc_;
+  Context&      cxt_;
+  char const*   first_; // The start of the input
+  char const*   cur_;   // The current character
+  char const*   last_;  // The end of the input
+  char const*   tok_;   // The start of the current token
+  Token_buffer& buf_;
+  int           input_; // The index of the input in the buffer
+  std::vector<Token_buffer::Index> braces_; // Unmatched opening braces
+  Spelling_map* cache_; // Symbols by spelling
+  std::mutex*   lock_;  // Guards the symbol table, if shared
 };
 
 
+// Prepare to lex concurrently with other lexers on the same context.
+// Spellings are cached in the given map, which must not be shared with
+// other lexers. The symbol table is only accessed while holding the
+// given lock, which must be shared by all lexers.
+inline void
+Lexer::share(Spelling_map& cache, std::mutex& lock)
+{
+  cache_ = &cache;
+  lock_ = &lock;
+}
+
+
+// Returns true when all characters have been consumed.
+inline bool
+Lexer::at_end() const
+{
+  return cur_ == last_;
+}
+
+
+// Returns the current character, or 0 at the end of input.
+inline char
+Lexer::lookahead() const
+{
+  return cur_ != last_ ? *cur_ : 0;
+}
+
+
+// Consume the current character.
+inline void
+Lexer::get()
+{
+  ++cur_;
+}
+
+
+// Returns the spelling of the current token.
+inline Slice
+Lexer::spelling() const
+{
+  return Slice(tok_, cur_);
+}
+
+
 } // namespace banjo
 
 
@@ -22,25 +22,26 @@ namespace banjo
 // Throws an exception if no matching declarations are found.
 //
 // Lookup ends as soon as a declaration is found for the given name.
+// Rather than searching each enclosing scope, this finds the innermost
+// visible binding of the name (see find_binding). Worker contexts do
+// not maintain visibility, so they search the enclosing scopes.
 //
 // TODO: How should we handle non-simple id's like operator-ids
 // and conversion function ids.
-Decl_list
+//
+// TODO: The "advanced" search rules depend on the declaration
+// associated with the current scope. For example, unqualified
+// lookup within a class searches base classes.
+Overload_set&
 unqualified_lookup(Context& cxt, Name const& name)
 {
-  Scope* p = &cxt.current_scope();
-  while (p) {
-    // In general, a name used in any context must be declared
-    // before it's use. Search this scope for such a declaration.
-    if (Overload_set* ovl = p->lookup(name))
-      return *ovl;
-
-    // TODO: The "advanced" search rules depend on the declaration
-    // associated with the current scope. For example, unqualified
-    // lookup within a class searches base classes.
-
-    p = p->enclosing_scope();
-  }
+  Overload_set* ovl;
+  if (cxt.is_worker())
+    ovl = find_binding(cxt.current_scope(), name);
+  else
+    ovl = find_binding(name);
+  if (ovl)
+    return *ovl;
 
   error(cxt, "no matching declaration for '{}'", name);
   throw Lookup_error("no matching declaration");
@@ -52,7 +53,7 @@ unqualified_lookup(Context& cxt, Name const& name)
 Decl&
 simple_lookup(Context& cxt, Name const& name)
 {
-  Decl_list result = unqualified_lookup(cxt, name);
+  Overload_set& result = unqualified_lookup(cxt, name);
 
   // TODO: Can we find names that are similar to name in order to support 
   // better diagnostics? As in "did you mean...?".
@@ -137,7 +138,7 @@ requirement_lookup(Context& cxt, Expr& e)
   Type_list t1 = get_operand_types(e); // Yuck.
   for (Expr& e2 : s.exprs) {
     // Expressions of different kinds are not comparable.
-    if (typeid(e) != typeid(e2))
+    if (!is_same_kind(e, e2))
       continue;
 
     // Compare the types of operands.
@@ -13,7 +13,7 @@ namespace banjo
 
 
 Decl& simple_lookup(Context&, Name const&);
-Decl_list unqualified_lookup(Context&, Name const&);
+Overload_set& unqualified_lookup(Context&, Name const&);
 Decl_list qualified_lookup(Context&, Type&, Name const&);
 
 // Decl_list argument_dependent_lookup(Scope&, Expr_list&);
@@ -2,9 +2,12 @@
 // All rights reserved
 
 #include "context.hpp"
+#include "factory.hpp"
+#include "input.hpp"
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "printer.hpp"
+#include "thread-pool.hpp"
 
 #include "gen/llvm/generator.hpp"
 
@@ -12,34 +15,35 @@
 #include <lingo/io.hpp>
 #include <lingo/error.hpp>
 
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <mutex>
 
 
 using namespace lingo;
 using namespace banjo;
 
 
-using File_seq = std::vector<File*>;
+using Path_seq = std::vector<String>;
+using File_seq = std::vector<std::unique_ptr<File>>;
+using Token_buffers = std::vector<Token_buffer>;
 
 
 struct Options
 {
-  ~Options();
-
   String   emit    = "bano";
-  File_seq inputs  = {};
+  bool     stats   = false;
+  bool     mapped  = false;
+  bool     memo    = false;
+  bool     defer   = false;
+  bool     decls   = false;
+  int      jobs    = 1;
+  Path_seq inputs  = {};
 };
 
 
 
-Options::~Options()
-{
-  for (File* f : inputs)
-    delete f;
-}
-
-
-
 using Parse_fn = void (*)(int&, int, char**, Options&);
 using Options_map = std::unordered_map<String, Parse_fn>;
 
@@ -55,10 +59,70 @@ parse_emit(int& argn, int argc, char* argv[], Options& opts)
 }
 
 
+// Print statistics about the translation after it completes.
+void
+parse_stats(int& argn, int argc, char* argv[], Options& opts)
+{
+  opts.stats = true;
+}
+
+
+// Lex inputs directly from memory-mapped files.
+void
+parse_mmap(int& argn, int argc, char* argv[], Options& opts)
+{
+  opts.mapped = true;
+}
+
+
+// Lex input files and elaborate function definitions concurrently
+// using N threads. With more than one job, definitions are deferred
+// so that they can be elaborated after all declarations.
+void
+parse_jobs(int& argn, int argc, char* argv[], Options& opts)
+{
+  if (argn + 1 == argc) {
+    error("expected a number of jobs after '-j'");
+    exit(1);
+  }
+  opts.jobs = std::atoi(argv[++argn]);
+  if (opts.jobs < 1) {
+    error("invalid number of jobs '{}'", argv[argn]);
+    exit(1);
+  }
+}
+
+
+// Elaborate function definitions only when they are needed.
+void
+parse_defer_bodies(int& argn, int argc, char* argv[], Options& opts)
+{
+  opts.defer = true;
+}
+
+
+// Stop after elaborating declarations and overloads. Function
+// definitions are not elaborated, and no output is generated.
+void
+parse_syntax_only_decls(int& argn, int argc, char* argv[], Options& opts)
+{
+  opts.defer = true;
+  opts.decls = true;
+}
+
+
+// Memoize speculative parses.
+void
+parse_memo(int& argn, int argc, char* argv[], Options& opts)
+{
+  opts.memo = true;
+}
+
+
 void
 parse_positional(int& argn, int argc, char* argv[], Options& opts)
 {
-  opts.inputs.push_back(new File(argv[argn]));
+  opts.inputs.push_back(argv[argn]);
 }
 
 
@@ -66,7 +130,13 @@ void
 parse_args(int argc, char* argv[], Options& opts)
 {
   static Options_map all {
-    {"-emit", parse_emit}
+    {"-emit", parse_emit},
+    {"-stats", parse_stats},
+    {"-mmap", parse_mmap},
+    {"-j", parse_jobs},
+    {"-fparse-memo", parse_memo},
+    {"-fdefer-bodies", parse_defer_bodies},
+    {"-fsyntax-only-decls", parse_syntax_only_decls}
   };
 
 
@@ -87,6 +157,67 @@ parse_args(int argc, char* argv[], Options& opts)
 
 
 
+// Lex each input in turn, appending its tokens to the token buffer
+// of the translation.
+void
+lex_inputs(Context& cxt, Options const& opts, File_seq& files)
+{
+  Token_buffer& buf = cxt.tokens();
+  for (std::size_t i = 0; i < opts.inputs.size(); ++i) {
+    if (opts.mapped) {
+      Mapped_file f(opts.inputs[i]);
+      Lexer lex(cxt, f, buf);
+      lex();
+    } else {
+      Lexer lex(cxt, *files[i], buf);
+      lex();
+    }
+  }
+}
+
+
+// Lex the inputs concurrently. Each input is lexed by a separate task
+// into its own token buffer, with its own spelling cache. Accesses to
+// the symbol table and diagnostics are serialized. The buffers are
+// appended to the translation's buffer in the order of the inputs.
+//
+// Note that lingo files are read before the tasks start, since their
+// construction is not known to be thread-safe.
+void
+lex_inputs_parallel(Context& cxt, Options const& opts, File_seq& files)
+{
+  std::mutex lock;
+  Token_buffers bufs(opts.inputs.size());
+  {
+    Thread_pool pool(opts.jobs);
+    for (std::size_t i = 0; i < opts.inputs.size(); ++i) {
+      pool.submit([&, i]() {
+        Spelling_map cache;
+        if (opts.mapped) {
+          Mapped_file f(opts.inputs[i]);
+          Lexer lex(cxt, f, bufs[i]);
+          lex.share(cache, lock);
+          lex();
+        } else {
+          Lexer lex(cxt, *files[i], bufs[i]);
+          lex.share(cache, lock);
+          lex();
+        }
+      });
+    }
+    pool.wait();
+  }
+
+  Token_buffer& buf = cxt.tokens();
+  std::size_t n = 0;
+  for (Token_buffer const& b : bufs)
+    n += b.size();
+  buf.reserve(n);
+  for (Token_buffer& b : bufs)
+    buf.append(b);
+}
+
+
 int
 main(int argc, char* argv[])
 {
@@ -94,6 +225,8 @@ main(int argc, char* argv[])
 
   Options opts;
   parse_args(argc, argv, opts);
+  cxt.memoize_parses(opts.memo);
+  cxt.defer_definitions(opts.defer || opts.jobs > 1);
 
   // Check post-configuration options.
   if (opts.inputs.empty()) {
@@ -103,26 +236,35 @@ main(int argc, char* argv[])
 
   // Initial file processing.
 
-  // Perform character and lexical analysis.
-  Token_seq toks;
-  for (File* f : opts.inputs) {
-    Character_stream cs(*f);
-    Token_stream ts;
-    Lexer lex(cxt, cs, ts);
-
-    // Lex tokens.
-    lex();
-    if (error_count())
-      return 1;
-    toks.splice(toks.end(), ts.buf_);
+  // Perform character and lexical analysis. Note that input files
+  // must outlive any diagnostics that refer to them.
+  File_seq files;
+  if (!opts.mapped) {
+    for (String const& path : opts.inputs)
+      files.emplace_back(new File(path));
   }
+  if (opts.jobs > 1 && opts.inputs.size() > 1)
+    lex_inputs_parallel(cxt, opts, files);
+  else
+    lex_inputs(cxt, opts, files);
+  if (error_count())
+    return 1;
 
   // Perform syntactic analysis.
-  Token_stream ts(toks);
+  banjo::Token_stream ts(cxt.tokens());
   Parser parse(cxt, ts);
   Stmt& stmt = parse();
 
-  if (opts.emit == "banjo") {
+  // With -fsyntax-only-decls, translation stops after declarations
+  // and overloads have been elaborated. Otherwise, deferred definitions
+  // are elaborated before any output is produced.
+  if (!opts.decls)
+    elaborate_deferred_definitions(cxt, opts.jobs);
+
+  if (opts.decls) {
+    // No output.
+  }
+  else if (opts.emit == "banjo") {
     std::cout << stmt << '\n';
   }
   else if (opts.emit == "llvm") {
@@ -130,4 +272,10 @@ main(int argc, char* argv[])
     gen(stmt);
   }
 
+  if (opts.stats) {
+    print_statistics(std::cerr, *cxt.uniq);
+    if (opts.memo)
+      print_statistics(std::cerr, cxt.memo_statistics());
+  }
+
 }
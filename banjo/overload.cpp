@@ -27,74 +27,69 @@ Overload_set::name()
 }
 
 
-std::ostream&
-operator<<(std::ostream& os, Overload_set const& ovl)
-{
-  for (Decl const& d : ovl)
-    os << d << '\n';
-  return os;
-}
-
-
-// -------------------------------------------------------------------------- //
-// Overloadable declarations
-
-static inline bool
-conflicting_declaration(Decl& prev, Decl& given)
+// Returns a previously indexed function declaration having the same
+// parameter types as d, or nullptr if there is no such declaration or
+// d is not a function.
+Decl*
+Overload_set::find_signature(Decl const& d) const
 {
-  error("declaration of '{}' conflicts with a previous declaration", given.name());
-  return false;
+  if (Function_decl const* f = as<Function_decl>(&d)) {
+    auto iter = sigs.find(&f->type().parameter_types());
+    if (iter != sigs.end())
+      return iter->second;
+  }
+  return nullptr;
 }
 
 
-static inline bool
-non_overloadable_declaration(Decl& prev, Decl& given)
+// Add the function declaration d to the signature index. Only the first
+// function declared with a given list of parameter types is indexed.
+// Declarations that are not functions are not indexed.
+//
+// An indexed function is also added to the bucket for its number of
+// parameters, under the type of its first parameter.
+void
+Overload_set::index_signature(Decl& d)
 {
-  error("cannot overload '{}' with a previous declaration", given.name());
-  return false;
+  Function_decl* f = as<Function_decl>(&d);
+  if (!f)
+    return;
+  Type_list& parms = f->type().parameter_types();
+  if (!sigs.emplace(&parms, f).second)
+    return;
+
+  if (arities.size() <= parms.size())
+    arities.resize(parms.size() + 1);
+  Arity_bucket& b = arities[parms.size()];
+  b.fns.push_back(*f);
+  if (!parms.empty()) {
+    Type& t = parms.front();
+    Decl_list& fns = b.byfirst[&t];
+    if (fns.empty())
+      b.firsts.push_back(&t);
+    fns.push_back(*f);
+  }
 }
 
 
-// Function declarations that differ only in the return type
-// cannot be overloaded.
-bool
-can_overload(Function_decl& prev, Function_decl& given)
+// Returns the functions taking n parameters, or nullptr if there are
+// no such functions.
+Arity_bucket*
+Overload_set::arity(std::size_t n)
 {
-  Function_type& t1 = prev.type();
-  Function_type& t2 = given.type();
-  if (is_equivalent(t1.parameter_types(), t2.parameter_types())) {
-    if (!is_equivalent(t1.return_type(), t2.return_type())) {
-      return non_overloadable_declaration(prev, given);
-    }
-  }
-  return true;
+  if (n < arities.size() && !arities[n].fns.empty())
+    return &arities[n];
+  return nullptr;
 }
 
 
-// Returns true if we can categorically overload the given declaration
-// with a previous declaration. Only functions and function templates can
-// be overloaded.
-//
-// TODO: This will need to be adjusted when we add member functions.
-bool
-can_overload(Decl& prev, Decl& given)
+std::ostream&
+operator<<(std::ostream& os, Overload_set const& ovl)
 {
-  // Only functions and function templates can be overloaded. There
-  // are some restrictions on the overloading of functions.
-  if (Function_decl* f1 = as<Function_decl>(&prev)) {
-    if (Function_decl* f2 = as<Function_decl>(&given))
-      return can_overload(*f1, *f2);
-  }
-
-  // Only functions and funtion templates can be overloaded.
-  Decl& d1 = prev.parameterized_declaration();
-  Decl& d2 = given.parameterized_declaration();
-  if (!is_function(d1) || !is_function(d2))
-    return conflicting_declaration(prev, given);
-
-  return true;
+  for (Decl const& d : ovl)
+    os << d << '\n';
+  return os;
 }
 
 
-
 } // namespace banjo
@@ -6,16 +6,70 @@
 
 #include "language.hpp"
 
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 
 namespace banjo
 {
 
+// Hashes the parameter types of a function by the identity of those
+// types. Parameter types are canonical, so functions with equivalent
+// parameter types have the same list of types.
+struct Signature_hash
+{
+  std::size_t operator()(Type_list const* t) const
+  {
+    Hasher h(t->size());
+    for (Type const* p : t->base())
+      h.add(p);
+    return h.value();
+  }
+};
+
+
+struct Signature_eq
+{
+  bool operator()(Type_list const* a, Type_list const* b) const
+  {
+    return a->base() == b->base();
+  }
+};
+
+
+// Maps the parameter types of functions to a function declared with
+// those parameter types.
+using Signature_map = std::unordered_map<Type_list const*, Decl*, Signature_hash, Signature_eq>;
+
+
+// The function declarations of an overload set that have the same
+// number of parameters. Functions with at least one parameter are
+// also grouped by the type of their first parameter. Parameter types
+// are canonical, so they are compared by address.
+struct Arity_bucket
+{
+  using First_map = std::unordered_map<Type const*, Decl_list>;
+
+  Decl_list          fns;    // Functions, in the order they were indexed
+  std::vector<Type*> firsts; // Distinct first parameter types
+  First_map          byfirst; // Functions by first parameter type
+};
+
+
 // Represents a set of overloaded declarations. All declarations have
 // the same name, scope, and kind, but may differ in their different
 // types and constraints.
 //
+// The overload set also indexes its function declarations by their
+// parameter types, so that declarations that could conflict can be
+// found without comparing each pair of declarations. Declarations are
+// indexed when their types are known (see index_signature).
+//
+// For overload resolution, the indexed functions are also grouped by
+// their number of parameters and the type of their first parameter, so
+// that candidates for a call that cannot be viable are never considered.
+// Functions are added to those groups as they are indexed.
+//
 // Note that an overload set is never empty.
 struct Overload_set : Decl_list
 {
@@ -34,10 +88,17 @@ struct Overload_set : Decl_list
   // Inserts a new declaration into the overload set. The declaration
   // shall be overloadable with all previous elements of the set.
   void insert(Decl& d) { push_back(d); }
-};
 
+  // Signature index
+  Decl* find_signature(Decl const&) const;
+  void  index_signature(Decl&);
 
-bool can_overload(Decl&, Decl&);
+  // Candidate index
+  Arity_bucket* arity(std::size_t);
+
+  Signature_map             sigs;
+  std::vector<Arity_bucket> arities; // Functions by number of parameters
+};
 
 
 std::ostream& operator<<(std::ostream&, Overload_set const&);
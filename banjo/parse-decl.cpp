@@ -234,14 +234,14 @@ Parser::variable_declaration()
 Type&
 Parser::unparsed_variable_type()
 {
-  Token_seq toks;
+  Token_stream::Position first = tokens.position();
   Brace_matching_sentinel is_non_nested(*this);
   while (!is_eof()) {
     if (next_token_is_one_of(semicolon_tok, eq_tok) && is_non_nested())
       break;
-    toks.push_back(accept());
+    skip();
   }
-  return on_unparsed_type(std::move(toks));
+  return on_unparsed_type(tokens.range(first, tokens.position()));
 }
 
 
@@ -249,14 +249,14 @@ Parser::unparsed_variable_type()
 Expr&
 Parser::unparsed_variable_initializer()
 {
-  Token_seq toks;
+  Token_stream::Position first = tokens.position();
   Brace_matching_sentinel is_non_nested(*this);
   while (!is_eof()) {
     if (next_token_is(semicolon_tok) && is_non_nested())
       break;
-    toks.push_back(accept());
+    skip();
   }
-  return on_unparsed_expression(std::move(toks));
+  return on_unparsed_expression(tokens.range(first, tokens.position()));
 }
 
 
@@ -298,7 +298,7 @@ Expr&
 Parser::equal_initializer(Decl& d)
 {
   require(eq_tok);
-  Expr& expr = expression();
+  Expr& expr = required(expression());
   return on_equal_initialization(d, expr);
 }
 
@@ -478,14 +478,14 @@ Parser::parameter_declaration()
 Type&
 Parser::unparsed_parameter_type()
 {
-  Token_seq toks;
+  Token_stream::Position first = tokens.position();
   Brace_matching_sentinel is_non_nested(*this);
   while (true) {
     if (next_token_is_one_of(comma_tok, rparen_tok) && is_non_nested())
       break;
-    toks.push_back(accept());
+    skip();
   }
-  return on_unparsed_type(std::move(toks));
+  return on_unparsed_type(tokens.range(first, tokens.position()));
 }
 
 
@@ -493,14 +493,14 @@ Parser::unparsed_parameter_type()
 Type&
 Parser::unparsed_return_type()
 {
-  Token_seq toks;
+  Token_stream::Position first = tokens.position();
   Brace_matching_sentinel is_non_nested(*this);
   while (!is_eof()) {
     if (next_token_is_one_of(lbrace_tok, eq_tok) && is_non_nested())
       break;
-    toks.push_back(accept());
+    skip();
   }
-  return on_unparsed_type(std::move(toks));
+  return on_unparsed_type(tokens.range(first, tokens.position()));
 }
 
 
@@ -508,14 +508,14 @@ Parser::unparsed_return_type()
 Expr&
 Parser::unparsed_expression_body()
 {
-  Token_seq toks;
+  Token_stream::Position first = tokens.position();
   Brace_matching_sentinel is_non_nested(*this);
   while (!is_eof()) {
     if (next_token_is(semicolon_tok) && is_non_nested())
       break;
-    toks.push_back(accept());
+    skip();
   }
-  return on_unparsed_expression(std::move(toks));
+  return on_unparsed_expression(tokens.range(first, tokens.position()));
 }
 
 
@@ -527,16 +527,10 @@ Parser::unparsed_expression_body()
 Stmt&
 Parser::unparsed_function_body()
 {
-  Token_seq toks;
-  toks.push_back(match(lbrace_tok));
-  Brace_matching_sentinel is_non_nested(*this);
-  while (!is_eof()) {
-    if (next_token_is(rbrace_tok) && is_non_nested())
-      break;
-    toks.push_back(accept());
-  }
-  toks.push_back(match(rbrace_tok));
-  return on_unparsed_statement(std::move(toks));
+  Token_stream::Position first = tokens.position();
+  expect(lbrace_tok);
+  skip();
+  return on_unparsed_statement(tokens.range(first, tokens.position()));
 }
 
 
@@ -600,13 +594,13 @@ Parser::type_declaration()
 Type&
 Parser::unparsed_type_kind()
 {
-  Token_seq toks;
+  Token_stream::Position first = tokens.position();
   while (!is_eof()) {
     if (next_token_is_one_of(lbrace_tok) && !in_braces())
       break;
-    toks.push_back(accept());
+    skip();
   }
-  return on_unparsed_type(std::move(toks));
+  return on_unparsed_type(tokens.range(first, tokens.position()));
 }
 
 
@@ -618,16 +612,10 @@ Parser::unparsed_type_kind()
 Stmt&
 Parser::unparsed_type_body()
 {
-  Token_seq toks;
-  toks.push_back(match(lbrace_tok));
-  Brace_matching_sentinel is_non_nested(*this);
-  while (!is_eof()) {
-    if (next_token_is(rbrace_tok) && is_non_nested())
-      break;
-    toks.push_back(accept());
-  }
-  toks.push_back(match(rbrace_tok));
-  return on_unparsed_statement(std::move(toks));
+  Token_stream::Position first = tokens.position();
+  expect(lbrace_tok);
+  skip();
+  return on_unparsed_statement(tokens.range(first, tokens.position()));
 }
 
 
@@ -739,7 +727,7 @@ Parser::type_template_parameter()
   // Parse the default argument.
   Type* t = nullptr;
   if (lookahead() == eq_tok)
-    t = &type();
+    t = &required(type());
 
   // Point of declaration.
   Decl* d;
@@ -839,7 +827,7 @@ Def&
 Parser::concept_definition(Decl& d)
 {
   if (match_if(eq_tok)) {
-    Expr& e = expression();
+    Expr& e = required(expression());
     Def& def = on_concept_definition(d, e);
     match(semicolon_tok);
     return def;
@@ -10,14 +10,111 @@ namespace banjo
 {
 
 
+// -------------------------------------------------------------------------- //
+// Binary operators
+
+namespace
+{
+
+// The precedence of binary operators. Operators with higher precedence
+// bind more tightly than those with lower precedence.
+enum Precedence
+{
+  no_prec,
+  logical_or_prec,
+  logical_and_prec,
+  inclusive_or_prec,
+  exclusive_or_prec,
+  and_prec,
+  equality_prec,
+  relational_prec,
+  shift_prec,
+  additive_prec,
+  multiplicative_prec,
+};
+
+
+// The semantic action for a binary operator.
+using Binary_action = Expr& (Parser::*)(Token, Expr&, Expr&);
+
+
+// The precedence and semantic action of a binary operator.
+struct Binary_operator
+{
+  int           prec;
+  Binary_action action;
+};
+
+
+// Returns the binary operator for the token kind k. If k is not a
+// binary operator, its precedence is no_prec.
+inline Binary_operator
+get_binary_operator(Token_kind k)
+{
+  switch (k) {
+    case bar_bar_tok: return {logical_or_prec, &Parser::on_logical_or_expression};
+    case amp_amp_tok: return {logical_and_prec, &Parser::on_logical_and_expression};
+    case bar_tok: return {inclusive_or_prec, &Parser::on_or_expression};
+    case caret_tok: return {exclusive_or_prec, &Parser::on_xor_expression};
+    case amp_tok: return {and_prec, &Parser::on_and_expression};
+    case eq_eq_tok: return {equality_prec, &Parser::on_eq_expression};
+    case bang_eq_tok: return {equality_prec, &Parser::on_ne_expression};
+    case lt_tok: return {relational_prec, &Parser::on_lt_expression};
+    case gt_tok: return {relational_prec, &Parser::on_gt_expression};
+    case lt_eq_tok: return {relational_prec, &Parser::on_le_expression};
+    case gt_eq_tok: return {relational_prec, &Parser::on_ge_expression};
+    case lt_eq_gt_tok: return {relational_prec, &Parser::on_cmp_expression};
+    case lt_lt_tok: return {shift_prec, &Parser::on_lsh_expression};
+    case gt_gt_tok: return {shift_prec, &Parser::on_rsh_expression};
+    case plus_tok: return {additive_prec, &Parser::on_add_expression};
+    case minus_tok: return {additive_prec, &Parser::on_sub_expression};
+    case star_tok: return {multiplicative_prec, &Parser::on_mul_expression};
+    case slash_tok: return {multiplicative_prec, &Parser::on_div_expression};
+    case percent_tok: return {multiplicative_prec, &Parser::on_rem_expression};
+    default: return {no_prec, nullptr};
+  }
+}
+
+
+} // namespace
+
+
 // Parse an expression.
 //
 //    expression:
 //      logical-or-expression -- FIXME: Probably wrong
-Expr&
+//
+// Like the type grammar, the productions that may be matched by a
+// trial parse return nullptr when the expression cannot be matched
+// within the trial. The named binary expression productions are used
+// outside of trials, so they return a reference.
+Expr*
 Parser::expression()
 {
-  return logical_or_expression();
+  return binary_expression(logical_or_prec);
+}
+
+
+// Parse a sequence of binary operators whose precedence is at least
+// prec. This implements each of the binary expression productions
+// below by precedence climbing: the right operand of an operator is
+// parsed at the next higher precedence, which makes all binary
+// operators left associative.
+Expr*
+Parser::binary_expression(int prec)
+{
+  Expr* e1 = unary_expression();
+  while (e1) {
+    Binary_operator op = get_binary_operator(lookahead());
+    if (op.prec < prec)
+      break;
+    Token tok = accept();
+    Expr* e2 = binary_expression(op.prec + 1);
+    if (!e2)
+      return nullptr;
+    e1 = &(this->*op.action)(tok, *e1, *e2);
+  }
+  return e1;
 }
 
 
@@ -29,16 +126,7 @@ Parser::expression()
 Expr&
 Parser::logical_or_expression()
 {
-  Expr* e1 = &logical_and_expression();
-  while (true) {
-    if (Token tok = match_if(bar_bar_tok)) {
-      Expr& e2 = logical_and_expression();
-      e1 = &on_logical_or_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(logical_or_prec));
 }
 
 
@@ -47,20 +135,10 @@ Parser::logical_or_expression()
 //    logical-and-expression:
 //      inclusive-or-expression
 //      logical-and-expression '&&' inclusive-or-expression
-//
 Expr&
 Parser::logical_and_expression()
 {
-  Expr* e1 = &inclusive_or_expression();
-  while (true) {
-    if (Token tok = match_if(amp_amp_tok)) {
-      Expr& e2 = inclusive_or_expression();
-      e1 = &on_logical_and_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(logical_and_prec));
 }
 
 
@@ -69,21 +147,10 @@ Parser::logical_and_expression()
 //    inclusive-or-expression:
 //      exclusive-or-expression
 //      inclusive-or-expression '|' exclusive-or-expression
-//
-// FIXME: This skips the bitwise expressions.
 Expr&
 Parser::inclusive_or_expression()
 {
-  Expr* e1 = &exclusive_or_expression();
-  while (true) {
-    if (Token tok = match_if(bar_tok)) {
-      Expr& e2 = exclusive_or_expression();
-      e1 = &on_or_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(inclusive_or_prec));
 }
 
 
@@ -92,42 +159,22 @@ Parser::inclusive_or_expression()
 //    exclusive-or-expression:
 //      and-expression
 //      exclusive-or-expression '^' and-expression
-//
 Expr&
 Parser::exclusive_or_expression()
 {
-  Expr* e1 = &and_expression();
-  while (true) {
-    if (Token tok = match_if(caret_tok)) {
-      Expr& e2 = and_expression();
-      e1 = &on_xor_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(exclusive_or_prec));
 }
 
 
 // Parse a bitwise and expression.
 //
-//    exclusive-or-expression:
+//    and-expression:
 //      equality-expression
-//      exclusive-or-expression '&' equality-expression
-//
+//      and-expression '&' equality-expression
 Expr&
 Parser::and_expression()
 {
-  Expr* e1 = &equality_expression();
-  while (true) {
-    if (Token tok = match_if(amp_tok)) {
-      Expr& e2 = equality_expression();
-      e1 = &on_and_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(and_prec));
 }
 
 
@@ -140,19 +187,7 @@ Parser::and_expression()
 Expr&
 Parser::equality_expression()
 {
-  Expr* e1 = &relational_expression();
-  while (true) {
-    if (Token tok = match_if(eq_eq_tok)) {
-      Expr& e2 = relational_expression();
-      e1 = &on_eq_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(bang_eq_tok)) {
-      Expr& e2 = relational_expression();
-      e1 = &on_ne_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(equality_prec));
 }
 
 
@@ -168,28 +203,7 @@ Parser::equality_expression()
 Expr&
 Parser::relational_expression()
 {
-  Expr* e1 = &shift_expression();
-  while (true) {
-    if (Token tok = match_if(lt_tok)) {
-      Expr& e2 = shift_expression();
-      e1 = &on_lt_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(gt_tok)) {
-      Expr& e2 = shift_expression();
-      e1 = &on_gt_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(lt_eq_tok)) {
-      Expr& e2 = shift_expression();
-      e1 = &on_le_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(gt_eq_tok)) {
-      Expr& e2 = shift_expression();
-      e1 = &on_ge_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(lt_eq_gt_tok)) {
-      Expr& e2 = shift_expression();
-      e1 = &on_cmp_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(relational_prec));
 }
 
 
@@ -199,23 +213,10 @@ Parser::relational_expression()
 //      additive_expression:
 //      shift-expression '<<' additive_expression
 //      shift-expression '>>' additive_expression
-//
 Expr&
 Parser::shift_expression()
 {
-  Expr* e1 = &additive_expression();
-  while (true) {
-    if (Token tok = match_if(lt_lt_tok)) {
-      Expr& e2 = additive_expression();
-      e1 = &on_lsh_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(gt_gt_tok)) {
-      Expr& e2 = additive_expression();
-      e1 = &on_rsh_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(shift_prec));
 }
 
 
@@ -228,19 +229,7 @@ Parser::shift_expression()
 Expr&
 Parser::additive_expression()
 {
-  Expr* e1 = &multiplicative_expression();
-  while (true) {
-    if (Token tok = match_if(plus_tok)) {
-      Expr& e2 = multiplicative_expression();
-      e1 = &on_add_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(minus_tok)) {
-      Expr& e2 = unary_expression();
-      e1 = &on_sub_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(additive_prec));
 }
 
 
@@ -254,23 +243,7 @@ Parser::additive_expression()
 Expr&
 Parser::multiplicative_expression()
 {
-  Expr* e1 = &unary_expression();
-  while (true) {
-    // Use a switch?
-    if (Token tok = match_if(star_tok)) {
-      Expr& e2 = unary_expression();
-      e1 = &on_mul_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(slash_tok)) {
-      Expr& e2 = unary_expression();
-      e1 = &on_div_expression(tok, *e1, e2);
-    } else if (Token tok = match_if(percent_tok)) {
-      Expr& e2 = unary_expression();
-      e1 = &on_rem_expression(tok, *e1, e2);
-    } else {
-      break;
-    }
-  }
-  return *e1;
+  return required(binary_expression(multiplicative_prec));
 }
 
 
@@ -283,21 +256,21 @@ Parser::multiplicative_expression()
 //      '+' unary-expression
 //      '~' unary-expression
 //
-Expr&
+Expr*
 Parser::unary_expression()
 {
   if (Token tok = match_if(bang_tok)) {
-    Expr& e = unary_expression();
-    return on_logical_not_expression(tok, e);
+    Expr* e = unary_expression();
+    return e ? &on_logical_not_expression(tok, *e) : nullptr;
   } else if (Token tok = match_if(minus_tok)) {
-    Expr& e = unary_expression();
-    return on_neg_expression(tok, e);
+    Expr* e = unary_expression();
+    return e ? &on_neg_expression(tok, *e) : nullptr;
   } else if (Token tok = match_if(plus_tok)) {
-    Expr& e = unary_expression();
-    return on_pos_expression(tok, e);
+    Expr* e = unary_expression();
+    return e ? &on_pos_expression(tok, *e) : nullptr;
   } else if (Token tok = match_if(caret_tok)) {
-    Expr& e = unary_expression();
-    return on_compl_expression(tok, e);
+    Expr* e = unary_expression();
+    return e ? &on_compl_expression(tok, *e) : nullptr;
   } else {
     return postfix_expression();
   }
@@ -313,21 +286,21 @@ Parser::unary_expression()
 //      postfix-expression '[' expression ']'
 //
 // TODO: Add lots of stuff here.
-Expr&
+Expr*
 Parser::postfix_expression()
 {
-  Expr* e = &primary_expression();
-  while (true) {
+  Expr* e = primary_expression();
+  while (e) {
     if (lookahead() == dot_tok)
-      e = &dot_expression(*e);
+      e = dot_expression(*e);
     else if (lookahead() == lparen_tok)
-      e = &call_expression(*e);
+      e = call_expression(*e);
     else if (lookahead() == lbracket_tok)
-      e = &subscript_expression(*e);
+      e = subscript_expression(*e);
     else
       break;
   }
-  return *e;
+  return e;
 }
 
 
@@ -336,28 +309,33 @@ Parser::postfix_expression()
 //
 //    postfix-expression:
 //      postfix-expression '(' [expression-list] ')'
-Expr&
+Expr*
 Parser::call_expression(Expr& e)
 {
   Expr_list es;
   require(lparen_tok);
-  if (lookahead() != rparen_tok)
+  if (lookahead() != rparen_tok) {
     es = expression_list();
-  match(rparen_tok);
-  return on_call_expression(e, es);
+    if (es.empty())
+      return nullptr;
+  }
+  if (!match_or_fail(rparen_tok))
+    return nullptr;
+  return &on_call_expression(e, es);
 }
 
 
-Expr&
+Expr*
 Parser::dot_expression(Expr& e)
 {
   require(dot_tok);
-  Name& n = id();
-  return on_dot_expression(e, n);
+  if (Name* n = id())
+    return &on_dot_expression(e, *n);
+  return nullptr;
 }
 
 
-Expr&
+Expr*
 Parser::subscript_expression(Expr& e)
 {
   require(lbracket_tok);
@@ -372,13 +350,18 @@ Parser::subscript_expression(Expr& e)
 //    expression-list;
 //      expression
 //      expression-list ',' expression
+//
+// An expression-list is never empty, so an empty list indicates
+// failure.
 Expr_list
 Parser::expression_list()
 {
   Expr_list es;
   do {
-    Expr& e = expression();
-    es.push_back(e);
+    Expr* e = expression();
+    if (!e)
+      return Expr_list();
+    es.push_back(*e);
   } while (match_if(comma_tok));
   return es;
 }
@@ -392,20 +375,20 @@ Parser::expression_list()
 //      requires-expression
 //      lambda-expression
 //      '(' expression ')'
-Expr&
+Expr*
 Parser::primary_expression()
 {
   switch (lookahead()) {
     case true_tok:
-      return on_boolean_literal(accept(), true);
+      return &on_boolean_literal(accept(), true);
     case false_tok:
-      return on_boolean_literal(accept(), false);
+      return &on_boolean_literal(accept(), false);
     case integer_tok:
-      return on_integer_literal(accept());
+      return &on_integer_literal(accept());
     case identifier_tok:
       return id_expression();
     case requires_tok:
-      return requires_expression();
+      return &requires_expression();
     default:
       break;
   }
@@ -413,7 +396,12 @@ Parser::primary_expression()
   if (lookahead() == lparen_tok)
     return grouped_expression();
 
-  error(tokens.location(), "expected primary-expression");
+  if (trials)
+    return nullptr;
+  {
+    Lock_shared g(cxt);
+    error(tokens.location(), "expected primary-expression");
+  }
   throw Syntax_error("primary");
 }
 
@@ -428,11 +416,12 @@ Parser::primary_expression()
 //
 // A concept-check is a sequence of template arguments applied
 // to a concept-name.
-Expr&
+Expr*
 Parser::id_expression()
 {
-  Name& n = id();
-  return on_id_expression(n);
+  if (Name* n = id())
+    return &on_id_expression(*n);
+  return nullptr;
 }
 
 
@@ -475,12 +464,13 @@ Parser::requires_expression()
 // Parse a paren-enclosed expression.
 //
 //    grouped-expr ::= '(' expr ')'
-Expr&
+Expr*
 Parser::grouped_expression()
 {
   require(lparen_tok);
-  Expr& e = expression();
-  match(rparen_tok);
+  Expr* e = expression();
+  if (!e || !match_or_fail(rparen_tok))
+    return nullptr;
   return e;
 }
 
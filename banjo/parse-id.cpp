@@ -95,6 +95,9 @@ Parser::identifier()
 // do not affect the current parse. For example, for a variable
 // `v`, the expression `v(x)`` is valid only if `v` has class
 // type and provides a function call operator.
+//
+// Ids are parsed within trials, so these productions return nullptr
+// when the id cannot be matched within a trial parse.
 
 
 // Parse an unresolved id.
@@ -102,7 +105,7 @@ Parser::identifier()
 //    id:
 //      unqualified-id
 //      qualified-id
-Name&
+Name*
 Parser::id()
 {
   // FIXME: Re-enable this when I add scoping stuff.
@@ -131,7 +134,7 @@ Parser::id()
 //
 // FIXME: Finish implementing me. Note that the interpretation of
 // an identifier depends on both lookup and context.
-Name&
+Name*
 Parser::unqualified_id()
 {
   if (next_token_is(tilde_tok))
@@ -139,17 +142,19 @@ Parser::unqualified_id()
 
   if (Token tok = match_if(operator_tok)) {
     Operator_kind op = any_operator();
-    return on_operator_id(tok, op);
+    return &on_operator_id(tok, op);
   }
 
-  Token tok = match(identifier_tok);
+  Token tok = match_or_fail(identifier_tok);
+  if (!tok)
+    return nullptr;
 
   // FIXME: For a template-id or concept-id, we need to know about the
   // name. Presumably, at this point in the parse, we should have all possible
   // names available to us (or have the ability to find them).
   // We do not need a tentative parse for this.
 
-  return on_simple_id(tok);
+  return &on_simple_id(tok);
 }
 
 
@@ -158,12 +163,13 @@ Parser::unqualified_id()
 //
 //    destructor-id:
 //      '~' primary-type
-Name&
+Name*
 Parser::destructor_id()
 {
-  Token tok = match(tilde_tok);
-  Type& type = primary_type();
-  return on_destructor_id(tok, type);
+  Token tok = require(tilde_tok);
+  if (Type* type = primary_type())
+    return &on_destructor_id(tok, *type);
+  return nullptr;
 }
 
 
@@ -175,20 +181,27 @@ Parser::destructor_id()
 //      literal-id template-argument-clause
 //
 // TODO: Handle the operator and literal cases.
-Name&
+Name*
 Parser::template_id()
 {
-  Decl& temp = template_name();
+  Decl* temp = template_name();
+  if (!temp)
+    return nullptr;
 
   // FIXME: Accept a '>>' if we're in a nested template argument
   // list. Replace the '>>' with a '>' so that the outer list
   // will match.
   Term_list args;
-  match(lt_tok);
-  if (lookahead() != gt_tok)
+  if (!match_or_fail(lt_tok))
+    return nullptr;
+  if (lookahead() != gt_tok) {
     args = template_argument_list();
-  match(gt_tok);
-  return on_template_id(temp, args);
+    if (args.empty())
+      return nullptr;
+  }
+  if (!match_or_fail(gt_tok))
+    return nullptr;
+  return &on_template_id(*temp, args);
 }
 
 
@@ -196,16 +209,23 @@ Parser::template_id()
 //
 //    concept-id:
 //      concept-name '< [template-argument-list] '>'
-Name&
+Name*
 Parser::concept_id()
 {
-  Decl& con = concept_name();
+  Decl* con = concept_name();
+  if (!con)
+    return nullptr;
   Term_list args;
-  match(lt_tok);
-  if (lookahead() != gt_tok)
+  if (!match_or_fail(lt_tok))
+    return nullptr;
+  if (lookahead() != gt_tok) {
     args = template_argument_list();
-  match(gt_tok);
-  return on_concept_id(con, args);
+    if (args.empty())
+      return nullptr;
+  }
+  if (!match_or_fail(gt_tok))
+    return nullptr;
+  return &on_concept_id(*con, args);
 }
 
 
@@ -215,15 +235,18 @@ Parser::concept_id()
 //      template-argument
 //      template-argument-list ',' template-argument
 //
-// FIXME: Implement me.
+// A template-argument-list is never empty, so an empty list
+// indicates failure.
 Term_list
 Parser::template_argument_list()
 {
   Term_list args;
   do {
-    Term& arg = template_argument();
-    args.push_back(arg);
-  } while(lookahead() == comma_tok);
+    Term* arg = template_argument();
+    if (!arg)
+      return Term_list();
+    args.push_back(*arg);
+  } while (match_if(comma_tok));
   return args;
 }
 
@@ -238,15 +261,17 @@ Parser::template_argument_list()
 // FIXME: The expression must be a constant expression.
 //
 // FIXME: In the last instance, the template name can be qualified.
-Term&
+Term*
 Parser::template_argument()
 {
-  if (Type* t = match_if(&Parser::type))
-    return *t;
-  if (Expr* e = match_if(&Parser::expression))
-    return *e;
-  if (Decl* d = match_if(&Parser::template_name))
-    return *d;
+  if (Type* t = match_if(&Parser::type, "type"))
+    return t;
+  if (Expr* e = match_if(&Parser::expression, "expression"))
+    return e;
+  if (Decl* d = match_if(&Parser::template_name, "template-name"))
+    return d;
+  if (trials)
+    return nullptr;
   throw Syntax_error("expected template-argument");
 }
 
@@ -300,11 +325,12 @@ Parser::qualified_id()
 //
 //    template-name:
 //      identifier
-Decl&
+Decl*
 Parser::template_name()
 {
-  Token id = match(identifier_tok);
-  return on_template_name(id);
+  if (Token id = match_or_fail(identifier_tok))
+    return &on_template_name(id);
+  return nullptr;
 }
 
 
@@ -313,11 +339,12 @@ Parser::template_name()
 //
 //    concept-name:
 //      identifier
-Decl&
+Decl*
 Parser::concept_name()
 {
-  Token id = match(identifier_tok);
-  return on_concept_name(id);
+  if (Token id = match_or_fail(identifier_tok))
+    return &on_concept_name(id);
+  return nullptr;
 }
 
 
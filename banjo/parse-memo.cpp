@@ -0,0 +1,30 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "parse-memo.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+
+namespace banjo
+{
+
+// Print the hits and misses of each memoized production.
+void
+print_statistics(std::ostream& os, Memo_stats const& s)
+{
+  os << std::left << std::setw(20) << "production" << std::right
+     << std::setw(10) << "hits"
+     << std::setw(10) << "misses"
+     << '\n';
+  for (Memo_counts const& c : s.rules) {
+    os << std::left << std::setw(20) << c.rule << std::right
+       << std::setw(10) << c.hits
+       << std::setw(10) << c.misses
+       << '\n';
+  }
+}
+
+
+} // namespace banjo
@@ -0,0 +1,116 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_PARSE_MEMO_HPP
+#define BANJO_PARSE_MEMO_HPP
+
+// This module defines the memoization of speculative parses.
+//
+// When a trial parse fails, the parser backtracks and tries another
+// alternative. That alternative often parses the same tokens with the
+// same productions as the failed one (e.g., the template arguments
+// of a template-id parsed first as a type and then as an expression).
+// The memo records the result of each speculative parse, keyed on its
+// production and position, so that each production is parsed at most
+// once at each position.
+
+#include "prelude.hpp"
+#include "token-buffer.hpp"
+
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+
+namespace banjo
+{
+
+struct Term;
+struct Scope;
+
+
+// Identifies a speculative parse. The rule is the name of a production.
+// Names are compared by address, so they must be string literals.
+//
+// Because the results of parsing can depend on name lookup, the scope
+// in which the parse occurs is also part of the key.
+struct Memo_key
+{
+  char const*         rule;
+  Token_buffer::Index pos;
+  Scope const*        scope;
+};
+
+
+struct Memo_key_hash
+{
+  std::size_t operator()(Memo_key const& k) const
+  {
+    std::size_t h = std::hash<char const*>()(k.rule);
+    h = h * 31 + k.pos;
+    h = h * 31 + std::hash<Scope const*>()(k.scope);
+    return h;
+  }
+};
+
+
+struct Memo_key_eq
+{
+  bool operator()(Memo_key const& a, Memo_key const& b) const
+  {
+    return a.rule == b.rule && a.pos == b.pos && a.scope == b.scope;
+  }
+};
+
+
+// The result of a speculative parse. A null term indicates that the
+// parse failed. Otherwise, end is the position following the parse.
+struct Memo_entry
+{
+  Term*               term;
+  Token_buffer::Index end;
+};
+
+
+using Memo_table = std::unordered_map<Memo_key, Memo_entry, Memo_key_hash, Memo_key_eq>;
+
+
+// The number of memo lookups for a production. A production with many
+// hits is one where the grammar is frequently ambiguous.
+struct Memo_counts
+{
+  char const* rule;
+  std::size_t hits;
+  std::size_t misses;
+};
+
+
+// Lookup counts for each memoized production.
+struct Memo_stats
+{
+  Memo_counts& counts(char const*);
+
+  std::vector<Memo_counts> rules;
+};
+
+
+// Returns the counts for the given rule. There are only a handful of
+// memoized productions, so a linear search is sufficient.
+inline Memo_counts&
+Memo_stats::counts(char const* r)
+{
+  for (Memo_counts& c : rules)
+    if (c.rule == r)
+      return c;
+  rules.push_back(Memo_counts{r, 0, 0});
+  return rules.back();
+}
+
+
+void print_statistics(std::ostream&, Memo_stats const&);
+
+
+} // namespace banjo
+
+
+#endif
@@ -63,13 +63,13 @@ Parser::expression_requirement()
 Req&
 Parser::usage_requirement()
 {
-  Expr& e = expression();
+  Expr& e = required(expression());
   Req* r;
   if (match_if(colon_tok)) {
-    Type& t = type();
+    Type& t = required(type());
     r = &on_basic_requirement(e, t);
   } else if (match_if(arrow_tok)) {
-    Type& t = type();
+    Type& t = required(type());
     r = &on_conversion_requirement(e, t);
   } else {
     r = &on_basic_requirement(e);
@@ -125,7 +125,7 @@ Stmt&
 Parser::return_statement()
 {
   Token tok = require(return_tok);
-  Expr& e = expression();
+  Expr& e = required(expression());
   match(semicolon_tok);
   return on_return_statement(tok, e);
 }
@@ -141,7 +141,7 @@ Parser::if_statement()
 {
   require(if_tok);
   match(lparen_tok);
-  Expr& cond = expression();
+  Expr& cond = required(expression());
   match(rparen_tok);
   Stmt& branch1 = statement();
   if (match_if(else_tok)) {
@@ -158,7 +158,7 @@ Parser::while_statement()
 {
   require(while_tok);
   match(lparen_tok);
-  Expr& cond = expression();
+  Expr& cond = required(expression());
   match(rparen_tok);
   Stmt& body = statement();
   return on_while_statement(cond, body);
@@ -199,7 +199,7 @@ Parser::declaration_statement()
 Stmt&
 Parser::expression_statement()
 {
-  Expr& e = expression();
+  Expr& e = required(expression());
   Stmt& s = on_expression_statement(e);
   match(semicolon_tok);
   return s;
@@ -14,9 +14,13 @@ namespace banjo
 //    type:
 //      suffix-type
 //
+// Each production in this grammar returns nullptr when the type cannot
+// be matched within a trial parse. Outside a trial, the error is
+// diagnosed instead.
+//
 // TODO: Somewhere in this grammar, add general support for packed 
 // types (e.g., int...). 
-Type&
+Type*
 Parser::type()
 {
   return prefix_type();
@@ -27,12 +31,12 @@ Parser::type()
 //
 //    suffix-type:
 //      prefix-type ['...']
-Type&
+Type*
 Parser::suffix_type()
 {
-  Type& t = prefix_type();
-  if (match_if(ellipsis_tok))
-    return on_pack_type(t);
+  Type* t = prefix_type();
+  if (t && match_if(ellipsis_tok))
+    return &on_pack_type(*t);
   return t;
 }
 
@@ -56,39 +60,45 @@ Parser::suffix_type()
 // cv-qualified types, but can apply to pointers (presumably). It would
 // be nice if we could make the grammar reflect this, but it means
 // making lots of weird branches.
-Type&
+Type*
 Parser::prefix_type()
 {
   switch (lookahead()) {
     case amp_tok: {
       accept();
-      Type& t = unary_type();
-      return on_reference_type(t);
+      if (Type* t = unary_type())
+        return &on_reference_type(*t);
+      return nullptr;
     }
     case in_tok: {
       accept();
-      Type& t = unary_type();
-      return on_in_type(t);
+      if (Type* t = unary_type())
+        return &on_in_type(*t);
+      return nullptr;
     }
     case out_tok: {
       accept();
-      Type& t = unary_type();
-      return on_out_type(t);
+      if (Type* t = unary_type())
+        return &on_out_type(*t);
+      return nullptr;
     }
     case mutable_tok: {
       accept();
-      Type& t = unary_type();
-      return on_mutable_type(t);
+      if (Type* t = unary_type())
+        return &on_mutable_type(*t);
+      return nullptr;
     }
     case forward_tok: {
       accept();
-      Type& t = unary_type();
-      return on_forward_type(t);
+      if (Type* t = unary_type())
+        return &on_forward_type(*t);
+      return nullptr;
     }
     case consume_tok: {
       accept();
-      Type& t = unary_type();
-      return on_consume_type(t);
+      if (Type* t = unary_type())
+        return &on_consume_type(*t);
+      return nullptr;
     }
     default:
       break;
@@ -104,20 +114,23 @@ Parser::prefix_type()
 //      '*' unary-type 
 //      'const' unary-type
 //      'volatile' unary-type
-Type&
+Type*
 Parser::unary_type()
 {
   if (match_if(const_tok)) {
-    Type& t = unary_type();
-    return on_const_type(t);
+    if (Type* t = unary_type())
+      return &on_const_type(*t);
+    return nullptr;
   }
   if (match_if(volatile_tok)) {
-    Type& t = unary_type();
-    return on_volatile_type(t);
+    if (Type* t = unary_type())
+      return &on_volatile_type(*t);
+    return nullptr;
   }
   if (match_if(star_tok)) {
-    Type& t = unary_type();
-    return on_pointer_type(t);
+    if (Type* t = unary_type())
+      return &on_pointer_type(*t);
+    return nullptr;
   }
   return postfix_type();
 }
@@ -130,31 +143,32 @@ Parser::unary_type()
 //      postfix-type '[]'
 //      postfix-type '[' expression ']'
 //
-Type&
+Type*
 Parser::postfix_type()
 {
-  Type* t = &primary_type();
-  while (true) {
-    if (match_if(lbracket_tok))
-      t = &array_type(*t);   
+  Type* t = primary_type();
+  while (t) {
+    if (lookahead() == lbracket_tok)
+      t = array_type(*t);
     else
       break;
   }
-  return *t;
+  return t;
 }
 
 
 // Parse an array of slice type.
-Type&
- Parser::array_type(Type& t)
- {
-   match(lbracket_tok);
-   if (match_if(rbracket_tok))
-      return on_slice_type(t);
-   Expr& e = expression();
-   match(rbracket_tok);
-   return on_array_type(t, e);
- }
+Type*
+Parser::array_type(Type& t)
+{
+  require(lbracket_tok);
+  if (match_if(rbracket_tok))
+    return &on_slice_type(t);
+  Expr* e = expression();
+  if (!e || !match_or_fail(rbracket_tok))
+    return nullptr;
+  return &on_array_type(t, *e);
+}
  
 
 // Parse a primary type.
@@ -173,18 +187,18 @@ Type&
 //      '( unary-type )'
 //
 // FIXME: Design a better integer and FP type suite.
-Type&
+Type*
 Parser::primary_type()
 {
   switch (lookahead()) {
     case void_tok:
-      return on_void_type(accept());
+      return &on_void_type(accept());
     case bool_tok:
-      return on_bool_type(accept());
+      return &on_bool_type(accept());
     case int_tok:
-      return on_int_type(accept());
+      return &on_int_type(accept());
     case byte_tok:
-      return on_byte_type(accept());
+      return &on_byte_type(accept());
 
     // TODO: Implement me.
     case char_tok:
@@ -200,12 +214,15 @@ Parser::primary_type()
       return decltype_type();
 
     case type_tok:
-      return on_type_type(accept());
+      return &on_type_type(accept());
 
     case lparen_tok: {
-      // FIXME: We shouldn't need a tentative parse for this.
-      if (Type* t = match_if(&Parser::function_type))
-        return *t;
+      // A function type is a parenthesized list followed by '->'. The
+      // closing paren is found by the lexer, so no trial is needed.
+      Token_stream::Position p = tokens.matching();
+      if (p != Token_buffer::npos && p + 1 < tokens.last &&
+          tokens.buf->kind(p + 1) == arrow_tok)
+        return function_type();
       return grouped_type();
     }
 
@@ -219,11 +236,12 @@ Parser::primary_type()
 //
 //    id-type:
 //      id
-Type&
+Type*
 Parser::id_type()
 {
-  Name& n = id();
-  return on_id_type(n);
+  if (Name* n = id())
+    return &on_id_type(*n);
+  return nullptr;
 }
 
 
@@ -233,17 +251,21 @@ Parser::id_type()
 //      '(' [type-list] ')' type
 //
 // TODO: A function should not be able to return a pack type.
-Type&
+Type*
 Parser::function_type()
 {
   Type_list types;
-  match(lparen_tok);
-  if (lookahead() != rparen_tok)
+  require(lparen_tok);
+  if (lookahead() != rparen_tok) {
     types = type_list();
-  match(rparen_tok);
-  match(arrow_tok);
-  Type& ret = type();
-  return on_function_type(types, ret);
+    if (types.empty())
+      return nullptr;
+  }
+  if (!match_or_fail(rparen_tok) || !match_or_fail(arrow_tok))
+    return nullptr;
+  if (Type* ret = type())
+    return &on_function_type(types, *ret);
+  return nullptr;
 }
 
 
@@ -252,13 +274,18 @@ Parser::function_type()
 //    type-list:
 //      type
 //      type-list ',' type
+//
+// A type-list is never empty, so an empty list indicates failure.
 Type_list
 Parser::type_list()
 {
   Type_list types;
-  types.push_back(type());
-  while (match_if(comma_tok))
-    types.push_back(type());
+  do {
+    Type* t = type();
+    if (!t)
+      return Type_list();
+    types.push_back(*t);
+  } while (match_if(comma_tok));
   return types;
 }
 
@@ -267,12 +294,13 @@ Parser::type_list()
 //
 //    grouped-type:
 //      '(' type ')'
-Type&
+Type*
 Parser::grouped_type()
 {
-  match(lparen_tok);
-  Type& t = unary_type();
-  match(rparen_tok);
+  require(lparen_tok);
+  Type* t = unary_type();
+  if (!t || !match_or_fail(rparen_tok))
+    return nullptr;
   return t;
 }
 
@@ -283,14 +311,16 @@ Parser::grouped_type()
 //      decltype '(' expression ')'
 //
 // TODO: Support decltype(auto).
-Type&
+Type*
 Parser::decltype_type()
 {
   Token tok = require(decltype_tok);
-  match(lparen_tok);
-  Expr& expr = expression();
-  match(rparen_tok);
-  return on_decltype_type(tok, expr);
+  if (!match_or_fail(lparen_tok))
+    return nullptr;
+  Expr* expr = expression();
+  if (!expr || !match_or_fail(rparen_tok))
+    return nullptr;
+  return &on_decltype_type(tok, *expr);
 }
 
 
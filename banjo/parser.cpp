@@ -41,7 +41,7 @@ Parser::symbols()
 bool
 Parser::is_eof() const
 {
-  return !peek();
+  return tokens.eof();
 }
 
 
@@ -57,7 +57,7 @@ Parser::peek() const
 Token_kind
 Parser::lookahead() const
 {
-  return Token_kind(peek().kind());
+  return Token_kind(tokens.kind());
 }
 
 
@@ -65,7 +65,7 @@ Parser::lookahead() const
 Token_kind
 Parser::lookahead(int n) const
 {
-  return Token_kind(tokens.peek(n).kind());
+  return Token_kind(tokens.kind(n));
 }
 
 
@@ -112,10 +112,7 @@ Parser::match(Token_kind k)
 {
   if (lookahead() == k)
     return accept();
-  String msg = format("expected '{}' but got '{}'",
-                      get_spelling(k),
-                      token_spelling(tokens));
-  throw Syntax_error(cxt, msg);
+  expected(k);
 }
 
 
@@ -134,6 +131,18 @@ Parser::match_if(Token_kind k)
 }
 
 
+// Match a token of kind k. Within a trial parse, a mismatch returns an
+// invalid token so that the production can report its failure by
+// returning. Outside a trial, a mismatch is diagnosed as by match().
+Token
+Parser::match_or_fail(Token_kind k)
+{
+  if (lookahead() != k && trials)
+    return Token();
+  return match(k);
+}
+
+
 // Require a token of the given kind. Behavior is udefined if the token
 // does not match.
 Token
@@ -158,26 +167,35 @@ Parser::require(char const* s)
 void
 Parser::expect(Token_kind k)
 {
-  if (next_token_is_not(k)) {
-    String msg = format("expected '{}' but got '{}'",
-                        get_spelling(k),
-                        token_spelling(tokens));
-    throw Syntax_error(cxt, msg);
-  }
+  if (next_token_is_not(k))
+    expected(k);
+}
+
+
+// Signal that a token of kind k was expected. Within a trial parse,
+// the failure is signaled without building a diagnostic.
+void
+Parser::expected(Token_kind k)
+{
+  if (trials)
+    throw Trial_failure();
+  String msg = format("expected '{}' but got '{}'",
+                      get_spelling(k),
+                      token_spelling(tokens));
+  throw Syntax_error(cxt, msg);
 }
 
 
 // Returns the current token and advances the underlying
 // token stream.
-//
-// TODO: Record information about matching braces here.
 Token
 Parser::accept()
 {
+  Token_stream::Position pos = tokens.position();
   Token tok = tokens.get();
 
   // Update the global input location.
-  cxt.input_location(tok.location());
+  cxt.input_location(*tokens.buf, pos);
 
   // If the token is a brace, then record that for the purpose of
   // brace matching and diagnostics.
@@ -185,7 +203,7 @@ Parser::accept()
     case lparen_tok:
     case lbrace_tok:
     case lbracket_tok:
-      open_brace(tok);
+      open_brace(pos);
       break;
 
     case rparen_tok:
@@ -199,50 +217,52 @@ Parser::accept()
 }
 
 
+// Consume the current token. If the token is an opening brace, then
+// all tokens through its matching closing brace are consumed. Matching
+// braces are found by the lexer, so the group is skipped without
+// examining the tokens within it.
 void
-Parser::open_brace(Token tok)
+Parser::skip()
 {
-  Braces& braces = state.braces;
-  braces.open(tok);
-}
-
-
-// Return the the kind of closing brace that would match the closing
-// token.
-static inline Token_kind
-get_closing_brace(Token tok)
-{
-  switch (tok.kind()) {
-    case lparen_tok: return rparen_tok;
-    case lbrace_tok: return rbrace_tok;
-    case lbracket_tok: return rbracket_tok;
-    default: lingo_unreachable();
+  Token_stream::Position p = tokens.matching();
+  if (p == Token_buffer::npos || !is_open_brace(lookahead())) {
+    accept();
+    return;
   }
+  tokens.reposition(p);
+  cxt.input_location(*tokens.buf, p);
+  tokens.get();
 }
 
 
-
-// TODO: It might be nice to have a function that returns the opener
-// for a closer.
-static inline bool
-is_matching_brace(Token left, Token right)
+void
+Parser::open_brace(Token_stream::Position pos)
 {
-  return get_closing_brace(left) == right.kind();
+  Braces& braces = state.braces;
+  braces.open(pos);
 }
 
 
+// Close the innermost brace with the token tok.
+//
+// Within a trial parse, an unmatched brace only indicates the failure
+// of the trial, so no diagnostic is emitted.
 void
 Parser::close_brace(Token tok)
 {
   Braces& braces = state.braces;
 
   if (braces.empty()) {
+    if (trials)
+      throw Trial_failure();
     error(cxt, "unmatched brace '{}'", tok);
     throw Syntax_error("mismatched brace");
   }
 
-  Token prev = braces.back();
-  if (!is_matching_brace(prev, tok)) {
+  Token_kind prev = Token_kind(tokens.buf->kind(braces.back()));
+  if (get_closing_brace(prev) != tok.kind()) {
+    if (trials)
+      throw Trial_failure();
     // FIXME: show the location of the matching brace.
     error(cxt, "unbalanced brace '{}'", tok);
     throw Syntax_error("unbalanced brace");
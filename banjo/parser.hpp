@@ -15,23 +15,105 @@ namespace banjo
 {
 
 // Maintains a stack of braces. Note that "braces" is meant to imply
-// any kind of bracketing characters.
-struct Braces : Token_seq
+// any kind of bracketing characters. Braces are represented by their
+// positions in the token buffer.
+//
+// While a checkpoint is active, each change to the stack is recorded in
+// an undo log. Rolling back to a checkpoint replays that log, so the
+// cost of a checkpoint does not depend on the depth of the stack.
+struct Braces
+{
+  using Index = Token_buffer::Index;
+
+  void open(Index);
+  void close();
+
+  Index back() const  { return stack.back(); }
+  bool  empty() const { return stack.empty(); }
+  int   size() const  { return stack.size(); }
+
+  int  checkpoint();
+  void commit(int);
+  void rollback(int);
+
+  std::vector<Index> stack;
+  std::vector<Index> undo;   // Closed braces, or npos for opened braces
+  int                active = 0; // The number of active checkpoints
+};
+
+
+inline void
+Braces::open(Index n)
+{
+  stack.push_back(n);
+  if (active)
+    undo.push_back(Index(Token_buffer::npos));
+}
+
+
+inline void
+Braces::close()
+{
+  if (active)
+    undo.push_back(stack.back());
+  stack.pop_back();
+}
+
+
+// Start recording changes to the stack, returning a checkpoint.
+inline int
+Braces::checkpoint()
+{
+  ++active;
+  return undo.size();
+}
+
+
+// Keep the changes made since the checkpoint n. The undo log is
+// discarded when the outermost checkpoint is committed.
+inline void
+Braces::commit(int)
+{
+  if (--active == 0)
+    undo.clear();
+}
+
+
+// Undo the changes made since the checkpoint n.
+inline void
+Braces::rollback(int n)
+{
+  while ((int)undo.size() > n) {
+    Index b = undo.back();
+    undo.pop_back();
+    if (b == Token_buffer::npos)
+      stack.pop_back();
+    else
+      stack.push_back(b);
+  }
+  if (--active == 0)
+    undo.clear();
+}
+
+
+// Thrown to indicate the failure of a trial parse by a production that
+// cannot report failure by returning nullptr. This carries no
+// diagnostic: the failure is recovered by the caller of the trial,
+// and no message is ever shown.
+struct Trial_failure
 {
-  void open(Token tok) { push_back(tok); }
-  void close()         { pop_back(); }
 };
 
 
 // The parser is responsible for transforming a stream of tokens
-// into nodes. The parser owns a reference to the buffer for its
-// tokens. This supports the resolution of source code locations.
+// into nodes. The parser owns a reference to a stream over the token
+// buffer. This supports the resolution of source code locations.
 struct Parser
 {
   using Specs = Specifier_set; // For brevity
 
   Parser(Context& cxt, Token_stream& ts)
-    : cxt(cxt), build(cxt), tokens(ts), state()
+    : cxt(cxt), build(cxt), tokens(ts), state(), trials(0)
   { }
 
   Stmt& operator()();
@@ -45,45 +127,46 @@ struct Parser
   Name& identifier();
 
   // Unresolved names
-  Name& id();
-  Name& unqualified_id();
-  Name& destructor_id();
+  Name* id();
+  Name* unqualified_id();
+  Name* destructor_id();
   Name& operator_id();
   Name& conversion_id();
   Name& literal_id();
-  Name& template_id();
-  Name& concept_id();
+  Name* template_id();
+  Name* concept_id();
   Name& qualified_id();
 
   // Name helpers
   Term_list template_argument_list();
-  Term& template_argument();
+  Term* template_argument();
 
   // Nested name specifiers
   Decl& nested_name_specifier();
 
   // Resolved names
-  Decl& template_name();
-  Decl& concept_name();
+  Decl* template_name();
+  Decl* concept_name();
 
   // Specifiers
 
   // Types
-  Type& type();
-  Type& suffix_type();
-  Type& prefix_type();
-  Type& unary_type();
-  Type& postfix_type();
-  Type& array_type(Type&);
-  Type& primary_type();
-  Type& id_type();
-  Type& grouped_type();
-  Type& function_type();
-  Type& decltype_type();
+  Type* type();
+  Type* suffix_type();
+  Type* prefix_type();
+  Type* unary_type();
+  Type* postfix_type();
+  Type* array_type(Type&);
+  Type* primary_type();
+  Type* id_type();
+  Type* grouped_type();
+  Type* function_type();
+  Type* decltype_type();
   Type_list type_list();
 
   // Expressions
-  Expr& expression();
+  Expr* expression();
+  Expr* binary_expression(int);
   Expr& logical_or_expression();
   Expr& logical_and_expression();
   Expr& inclusive_or_expression();
@@ -94,14 +177,14 @@ struct Parser
   Expr& shift_expression();
   Expr& additive_expression();
   Expr& multiplicative_expression();
-  Expr& unary_expression();
-  Expr& postfix_expression();
-  Expr& call_expression(Expr&);
-  Expr& dot_expression(Expr&);
-  Expr& subscript_expression(Expr&);
-  Expr& primary_expression();
-  Expr& id_expression();
-  Expr& grouped_expression();
+  Expr* unary_expression();
+  Expr* postfix_expression();
+  Expr* call_expression(Expr&);
+  Expr* dot_expression(Expr&);
+  Expr* subscript_expression(Expr&);
+  Expr* primary_expression();
+  Expr* id_expression();
+  Expr* grouped_expression();
   Expr& lambda_expression();
   Expr& requires_expression();
   Expr_list expression_list();
@@ -213,7 +296,9 @@ struct Parser
   void elaborate_variable_initializer(Variable_decl&);
   void elaborate_variable_initializer(Variable_decl&, Empty_def&);
   void elaborate_variable_initializer(Variable_decl&, Expression_def&);
+  bool defer_function_definition(Function_decl&);
   void elaborate_function_definition(Function_decl&);
+  void elaborate_function_body(Function_decl&);
   void elaborate_function_definition(Function_decl&, Expression_def&);
   void elaborate_function_definition(Function_decl&, Function_def&);
   void elaborate_type_definition(Type_decl&);
@@ -259,7 +344,7 @@ struct Parser
   Type& on_consume_type(Type&);
   Type& on_forward_type(Type&);
   Type& on_pack_type(Type&);
-  Type& on_unparsed_type(Token_seq&&);
+  Type& on_unparsed_type(Token_range);
 
   // Expressions
   Expr& on_logical_and_expression(Token, Expr&, Expr&);
@@ -292,7 +377,7 @@ struct Parser
   Expr& on_integer_literal(Token);
   Expr& on_requires_expression(Token, Decl_list&, Decl_list&, Req_list&);
 
-  Expr& on_unparsed_expression(Token_seq&&);
+  Expr& on_unparsed_expression(Token_range);
 
   // Statements
   Stmt& on_translation_statement(Stmt_list&&);
@@ -307,7 +392,7 @@ struct Parser
   Stmt& on_continue_statement();
   Stmt& on_declaration_statement(Decl&);
   Stmt& on_expression_statement(Expr&);
-  Stmt& on_unparsed_statement(Token_seq&&);
+  Stmt& on_unparsed_statement(Token_range);
   void on_statement_seq(Stmt_list&);
 
   // Super declarations
@@ -368,10 +453,14 @@ struct Parser
   bool       next_token_is_not(char const*);
   Token      match(Token_kind);
   Token      match_if(Token_kind);
+  Token      match_or_fail(Token_kind);
   Token      require(Token_kind);
   Token      require(char const*);
   void       expect(Token_kind);
   Token      accept();
+  void       skip();
+
+  [[noreturn]] void expected(Token_kind);
 
   template<typename... Kinds>
   bool next_token_is_one_of(Token_kind, Kinds...);
@@ -379,7 +468,7 @@ struct Parser
   bool next_token_is_one_of();
 
   // Braces
-  void open_brace(Token);
+  void open_brace(Token_stream::Position);
   void close_brace(Token);
   bool in_braces() const;
   bool in_level(int) const;
@@ -391,7 +480,9 @@ struct Parser
   Specs  take_decl_specs();
 
   // Tree matching.
-  template<typename T> T* match_if(T& (Parser::* p)());
+  template<typename T> T* match_if(T* (Parser::* p)());
+  template<typename T> T* match_if(T* (Parser::* p)(), char const*);
+  template<typename T> T& required(T*);
 
   // Resources
   Symbol_table& symbols();
@@ -426,6 +517,8 @@ struct Parser
   Builder       build;
   Token_stream& tokens;
   State         state;
+  int           trials; // The number of active trial parses
+  Memo_table    memo;   // Memoized trial parses
 };
 
 
@@ -508,59 +601,137 @@ Parser::Parsing_template::~Parsing_template()
 
 // The trial parser provides recovery information for the parser
 // class. If the trial parse fails, then the state of the underlying
-// parser is rewound to the state cached bythe trial parser.
+// parser is rewound to the checkpoint taken by the trial parser.
+//
+// A checkpoint is constant size: the token position, a checkpoint
+// of the brace stack, the specifiers, template state, and scope.
 //
 // TODO: Can we automatically detect failures without needing
 // an explicit indication of failure?
 struct Trial_parser
 {
   using Position = Token_stream::Position;
-  using State = Parser::State;
+  using Specs = Parser::Specs;
 
   Trial_parser(Parser& p)
     : parser(p)
     , pos(p.tokens.position())
-    , state(p.state)
+    , braces(p.state.braces.checkpoint())
+    , specs(p.state.specs)
+    , parms(p.state.template_parms)
+    , cons(p.state.template_cons)
     , scope(&p.current_scope())
     , fail(false)
-  { }
+  {
+    ++parser.trials;
+  }
 
   void failed() { fail = true; }
 
   ~Trial_parser()
   {
-    // TODO: Manage diagnostics as part of the parser in order to
-    // detet failures?
+    --parser.trials;
     if (fail) {
       parser.tokens.reposition(pos);
       parser.cxt.set_scope(*scope);
-      parser.state = state;
+      parser.state.braces.rollback(braces);
+      parser.state.specs = specs;
+      parser.state.template_parms = parms;
+      parser.state.template_cons = cons;
+    } else {
+      parser.state.braces.commit(braces);
     }
   }
 
-  Parser&  parser;
-  Position pos;
-  State    state;
-  Scope*   scope;
-  bool     fail;
+  Parser&    parser;
+  Position   pos;
+  int        braces;
+  Specs      specs;
+  Decl_list* parms;
+  Expr*      cons;
+  Scope*     scope;
+  bool       fail;
 };
 
 
-// Match a given tree.
+// Match a given tree. Returns nullptr if the tree cannot be matched,
+// in which case the parser is rewound to its state before the match.
+//
+// Within a trial, the production f reports a syntax error by returning
+// nullptr. Semantic errors are still thrown, as is a syntax error in a
+// production that cannot return a status (see required()); both also
+// indicate the failure of the trial.
 template<typename R>
 inline R*
-Parser::match_if(R& (Parser::* f)())
+Parser::match_if(R* (Parser::* f)())
 {
   Trial_parser p(*this);
   try {
-    return &(this->*f)();
+    if (R* r = (this->*f)())
+      return r;
+  } catch(Trial_failure&) {
   } catch(Translation_error&) {
-    p.failed();
   }
+  p.failed();
   return nullptr;
 }
 
 
+// Match a given tree as the production named by rule. When parses are
+// memoized, the result of the match is recorded so that matching the
+// same rule at the same position does not parse again.
+//
+// A successful match is recorded only when it leaves the brace stack
+// as it found it, so that a later hit need only reposition the token
+// stream.
+template<typename R>
+inline R*
+Parser::match_if(R* (Parser::* f)(), char const* rule)
+{
+  if (!cxt.memoize_parses())
+    return match_if(f);
+
+  Memo_key key {rule, tokens.position(), &current_scope()};
+  Memo_counts& counts = cxt.memo_statistics().counts(rule);
+  auto iter = memo.find(key);
+  if (iter != memo.end()) {
+    ++counts.hits;
+    Memo_entry const& e = iter->second;
+    if (!e.term)
+      return nullptr;
+    tokens.reposition(e.end);
+    if (e.end != key.pos)
+      cxt.input_location(*tokens.buf, e.end - 1);
+    return static_cast<R*>(e.term);
+  }
+  ++counts.misses;
+
+  int level = brace_level();
+  Token_stream::Position top = in_braces() ? state.braces.back() : 0;
+  R* r = match_if(f);
+  if (!r)
+    memo.emplace(key, Memo_entry{nullptr, 0});
+  else if (brace_level() == level && (!level || state.braces.back() == top))
+    memo.emplace(key, Memo_entry{r, tokens.position()});
+  return r;
+}
+
+
+// Returns the tree matched by a production that reports failure by
+// returning nullptr. Outside a trial, such a production diagnoses its
+// errors and never fails. Within a trial, the failure is propagated
+// through productions that cannot return a status by throwing a
+// Trial_failure, which is caught by match_if().
+template<typename T>
+inline T&
+Parser::required(T* p)
+{
+  if (!p)
+    throw Trial_failure();
+  return *p;
+}
+
+
 // This class defines a predicate that can be tested to determine if the
 // current token is in the same nesting level as when this object is
 // constructed.
@@ -580,6 +751,14 @@ struct Brace_matching_sentinel
 };
 
 
+// -------------------------------------------------------------------------- //
+// On-demand elaboration
+
+bool require_declaration(Context&, Decl&);
+bool elaborate_definition(Context&, Function_decl&);
+void elaborate_deferred_definitions(Context&, int = 1);
+
+
 } // nammespace banjo
 
 
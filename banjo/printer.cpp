@@ -104,11 +104,12 @@ Printer::token(Integer const& n)
 
 
 void
-Printer::tokens(Token_seq const& toks)
+Printer::tokens(Token_range toks)
 {
-  for (auto iter = toks.begin(); iter != toks.end(); ++iter) {
-    token(*iter);
-    if (std::next(iter) != toks.end())
+  Token_buffer const& buf = toks.buffer();
+  for (Token_range::Index i = toks.first; i != toks.last; ++i) {
+    token(buf.token(i));
+    if (i + 1 != toks.last)
       space();
   }
 }
@@ -5,6 +5,7 @@
 #define BANJO_PRINTER_HPP
 
 #include "token.hpp"
+#include "token-buffer.hpp"
 #include "language.hpp"
 
 #include <iosfwd>
@@ -38,7 +39,7 @@ struct Printer
   void token(String const&);
   void token(int);
   void token(Integer const&);
-  void tokens(Token_seq const&);
+  void tokens(Token_range);
 
   void binary_operator(Token_kind);
 
@@ -28,7 +28,7 @@ satisfy_concept(Context& cxt, Concept_cons& c)
 inline bool
 satisfy_predicate(Context& cxt, Predicate_cons& p)
 {
-  Value v = evaluate(p.expression());
+  Value v = evaluate(cxt, p.expression());
   return v.get_boolean();
 }
 
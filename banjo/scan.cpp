@@ -0,0 +1,241 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "scan.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BANJO_SCAN_X86 1
+#  include <immintrin.h>
+#endif
+
+
+namespace banjo
+{
+
+// -------------------------------------------------------------------------- //
+// Character classes
+
+namespace
+{
+
+// Build the character class table. This is evaluated at compile time.
+constexpr Char_table
+make_char_table()
+{
+  Char_table t {};
+  for (char const* p = " \t\n\v\f\r"; *p; ++p)
+    t.classes[int(*p)] |= space_char;
+  for (int c = 'a'; c <= 'z'; ++c)
+    t.classes[c] |= ident_char;
+  for (int c = 'A'; c <= 'Z'; ++c)
+    t.classes[c] |= ident_char;
+  for (int c = '0'; c <= '9'; ++c)
+    t.classes[c] |= digit_char | ident_char;
+  t.classes[int('_')] |= ident_char;
+  return t;
+}
+
+
+} // namespace
+
+
+constexpr Char_table char_classes = make_char_table();
+
+
+namespace
+{
+
+// -------------------------------------------------------------------------- //
+// Portable scanners
+
+char const*
+skip_space_portable(char const* first, char const* last)
+{
+  while (first != last && is_space_char(*first))
+    ++first;
+  return first;
+}
+
+
+// Note that memchr is usually vectorized by the C library.
+char const*
+find_newline_portable(char const* first, char const* last)
+{
+  void const* p = std::memchr(first, '\n', last - first);
+  return p ? static_cast<char const*>(p) : last;
+}
+
+
+#if BANJO_SCAN_X86
+
+// -------------------------------------------------------------------------- //
+// SSE2 scanners
+//
+// A character c is whitespace when it is ' ' or in the range ['\t', '\r'].
+// The range test is done by biasing c so that '\t' maps to the smallest
+// signed byte, and then comparing against the bias of '\r' + 1.
+
+__attribute__((target("sse2")))
+inline unsigned
+space_mask(__m128i v)
+{
+  __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+  __m128i x = _mm_add_epi8(v, _mm_set1_epi8(char(0x80 - '\t')));
+  __m128i cc = _mm_cmplt_epi8(x, _mm_set1_epi8(char(0x80 + '\r' - '\t' + 1)));
+  return _mm_movemask_epi8(_mm_or_si128(sp, cc));
+}
+
+
+__attribute__((target("sse2")))
+char const*
+skip_space_sse2(char const* first, char const* last)
+{
+  while (last - first >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(first));
+    unsigned m = ~space_mask(v) & 0xffff;
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 16;
+  }
+  return skip_space_portable(first, last);
+}
+
+
+__attribute__((target("sse2")))
+char const*
+find_newline_sse2(char const* first, char const* last)
+{
+  __m128i nl = _mm_set1_epi8('\n');
+  while (last - first >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(first));
+    unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 16;
+  }
+  return find_newline_portable(first, last);
+}
+
+
+// -------------------------------------------------------------------------- //
+// AVX2 scanners
+
+__attribute__((target("avx2")))
+inline unsigned
+space_mask(__m256i v)
+{
+  __m256i sp = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+  __m256i x = _mm256_add_epi8(v, _mm256_set1_epi8(char(0x80 - '\t')));
+  __m256i lim = _mm256_set1_epi8(char(0x80 + '\r' - '\t' + 1));
+  __m256i cc = _mm256_cmpgt_epi8(lim, x);
+  return _mm256_movemask_epi8(_mm256_or_si256(sp, cc));
+}
+
+
+__attribute__((target("avx2")))
+char const*
+skip_space_avx2(char const* first, char const* last)
+{
+  while (last - first >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(first));
+    unsigned m = ~space_mask(v);
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 32;
+  }
+  return skip_space_sse2(first, last);
+}
+
+
+__attribute__((target("avx2")))
+char const*
+find_newline_avx2(char const* first, char const* last)
+{
+  __m256i nl = _mm256_set1_epi8('\n');
+  while (last - first >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(first));
+    unsigned m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 32;
+  }
+  return find_newline_sse2(first, last);
+}
+
+#endif // BANJO_SCAN_X86
+
+
+// -------------------------------------------------------------------------- //
+// Selection
+
+using Scan_fn = char const* (*)(char const*, char const*);
+
+
+// The block scanners for the host processor.
+struct Scanners
+{
+  Scanners();
+
+  char const* name;
+  Scan_fn     space;
+  Scan_fn     newline;
+};
+
+
+Scanners::Scanners()
+  : name("portable"), space(skip_space_portable), newline(find_newline_portable)
+{
+#if BANJO_SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    name = "avx2";
+    space = skip_space_avx2;
+    newline = find_newline_avx2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    name = "sse2";
+    space = skip_space_sse2;
+    newline = find_newline_sse2;
+  }
+#endif
+}
+
+
+inline Scanners const&
+scanners()
+{
+  static Scanners s;
+  return s;
+}
+
+
+} // namespace
+
+
+// Skipping is usually short (e.g., a single space between tokens), so
+// the first character is checked before dispatching.
+char const*
+skip_space(char const* first, char const* last)
+{
+  if (first == last || !is_space_char(*first))
+    return first;
+  return scanners().space(first, last);
+}
+
+
+char const*
+find_newline(char const* first, char const* last)
+{
+  return scanners().newline(first, last);
+}
+
+
+char const*
+scanner_name()
+{
+  return scanners().name;
+}
+
+
+} // namespace banjo
@@ -0,0 +1,92 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_SCAN_HPP
+#define BANJO_SCAN_HPP
+
+// This module defines the character classes used by the lexer, and
+// block scanners used to skip runs of characters that do not form
+// tokens: whitespace and the text of line comments.
+//
+// Each scanner examines 16 (SSE2) or 32 (AVX2) characters at a time
+// when the target supports it. The implementation is selected once,
+// at run time, based on the features of the host processor. A portable
+// implementation is used otherwise.
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace banjo
+{
+
+// -------------------------------------------------------------------------- //
+// Character classes
+
+// The classes of characters recognized by the lexer. A character may
+// belong to several classes (e.g., digits are also identifier
+// characters).
+enum Char_class : std::uint8_t
+{
+  space_char = 0x01, // ' ', '\t', '\n', '\v', '\f', '\r'
+  digit_char = 0x02, // [0-9]
+  ident_char = 0x04, // [a-zA-Z0-9_]
+};
+
+
+// A table of the classes of each character.
+struct Char_table
+{
+  std::uint8_t classes[256];
+};
+
+
+extern Char_table const char_classes;
+
+
+// Returns the classes of the character c.
+inline unsigned
+char_class(char c)
+{
+  return char_classes.classes[static_cast<unsigned char>(c)];
+}
+
+
+// Returns true if c is a whitespace character.
+inline bool
+is_space_char(char c)
+{
+  return char_class(c) & space_char;
+}
+
+
+// Returns true if c can appear in an identifier.
+inline bool
+is_ident_char(char c)
+{
+  return char_class(c) & ident_char;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Block scanners
+
+// Returns a pointer to the first character in [first, last) that is
+// not whitespace, or last if there is no such character. The whitespace
+// characters are ' ', '\t', '\n', '\v', '\f', and '\r'.
+char const* skip_space(char const* first, char const* last);
+
+// Returns a pointer to the first newline character in [first, last),
+// or last if there is no such character.
+char const* find_newline(char const* first, char const* last);
+
+
+// The name of the block scanner selected for the host. This is one of
+// "avx2", "sse2", or "portable".
+char const* scanner_name();
+
+
+} // namespace banjo
+
+
+#endif
@@ -12,6 +12,85 @@ namespace banjo
 using Binding = Scope::Binding;
 
 
+namespace
+{
+
+// Link the binding b into the chain of bindings for n, before the
+// bindings in shallower scopes.
+void
+link_binding(Name const& n, Name_binding& b)
+{
+  Name_binding* inner = nullptr;
+  Name_binding* outer = n.bindings;
+  while (outer && outer->scope->depth > b.scope->depth) {
+    inner = outer;
+    outer = outer->outer;
+  }
+  b.inner = inner;
+  b.outer = outer;
+  if (inner)
+    inner->outer = &b;
+  else
+    n.bindings = &b;
+  if (outer)
+    outer->inner = &b;
+}
+
+
+// Remove the binding b from the chain of bindings for its name.
+void
+unlink_binding(Name_binding& b)
+{
+  if (b.inner)
+    b.inner->outer = b.outer;
+  else
+    b.name->bindings = b.outer;
+  if (b.outer)
+    b.outer->inner = b.inner;
+}
+
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+// Name maps
+
+constexpr std::size_t Name_map::small_size;
+
+
+Name_map::~Name_map()
+{
+  for (Name_binding* p = small(); p != small() + num; ++p)
+    p->~Name_binding();
+}
+
+
+// Insert the binding b into the map. The name of b must not be bound.
+Name_binding&
+Name_map::insert(Name_binding&& b)
+{
+  if (num < small_size)
+    return *new (small() + num++) Name_binding(std::move(b));
+  auto ins = large.emplace(b.name, std::move(b));
+  return ins.first->second;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Scopes
+
+// Remove the bindings of this scope from their chains.
+Scope::~Scope()
+{
+  if (!linked)
+    return;
+  names.for_each([](Name_binding& b) {
+    unlink_binding(b);
+  });
+}
+
+
 // Register a name binding for the declaration `d`.
 Binding&
 Scope::bind(Decl& d)
@@ -20,4 +99,48 @@ Scope::bind(Decl& d)
 }
 
 
+// Bind n to `d` in this scope.
+//
+// Note that the addition of declarations to an overload set
+// must be handled by semantic rules.
+Binding&
+Scope::bind(Name const& n, Decl& d)
+{
+  lingo_assert(count(n) == 0);
+  Name_binding& b = names.insert(Name_binding(n, *this, d));
+  if (linked)
+    link_binding(n, b);
+  return b;
+}
+
+
+// Returns the innermost visible declarations of n, or nullptr if no
+// such declarations exist. Bindings in scopes that are not visible
+// from the current scope are skipped.
+Overload_set*
+find_binding(Name const& n)
+{
+  for (Name_binding* b = n.bindings; b; b = b->outer) {
+    if (b->scope->visible)
+      return &b->decls;
+  }
+  return nullptr;
+}
+
+
+// Returns the innermost declarations of n in s or its enclosing scopes,
+// or nullptr if no such declarations exist. This searches each scope in
+// turn and does not depend on the visibility of scopes or the chains of
+// bindings, so it can be used when scopes are shared between threads.
+Overload_set*
+find_binding(Scope& s, Name const& n)
+{
+  for (Scope* p = &s; p; p = p->enclosing_scope()) {
+    if (Overload_set* ovl = p->lookup(n))
+      return ovl;
+  }
+  return nullptr;
+}
+
+
 } // namespace banjo
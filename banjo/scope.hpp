@@ -8,6 +8,9 @@
 #include "language.hpp"
 #include "overload.hpp"
 
+#include <type_traits>
+#include <unordered_map>
+
 
 namespace banjo
 {
@@ -15,9 +18,112 @@ namespace banjo
 // -------------------------------------------------------------------------- //
 // Scope definitions
 
+struct Scope;
+
+
+// A binding of a name to a set of declarations in a scope.
+//
+// The bindings of each name are also linked across scopes, in order
+// of decreasing scope depth, and the innermost binding is stored with
+// the name. At most one scope of each depth is visible at any time, so
+// the first visible binding in that chain is the innermost declaration
+// of the name (see find_binding).
+struct Name_binding
+{
+  Name_binding(Name const& n, Scope& s, Decl& d)
+    : name(&n), decls(d), scope(&s), inner(nullptr), outer(nullptr)
+  { }
+
+  Name const*   name;
+  Overload_set  decls;
+  Scope*        scope;
+  Name_binding* inner; // The binding in the next deeper scope
+  Name_binding* outer; // The binding in the next shallower scope
+};
+
+
+// Maps names to their bindings. Names bound in a scope are unique
+// within a context (see Builder::get_id), so they are hashed and
+// compared by address.
+//
+// Most scopes bind only a few names. The first few bindings are
+// stored within the map and searched linearly. When those are
+// exhausted, later bindings are stored in a hash table.
+//
+// Bindings are never moved, so references to a binding and its
+// overload set remain valid for the lifetime of the map, as they
+// would in a hash table alone.
+struct Name_map
+{
+  static constexpr std::size_t small_size = 8;
+
+  Name_map()
+    : num(0)
+  { }
+
+  ~Name_map();
+
+  // Non-copyable
+  Name_map(Name_map const&) = delete;
+  Name_map& operator=(Name_map const&) = delete;
+
+  Name_binding const* find(Name const&) const;
+  Name_binding*       find(Name const&);
+
+  Name_binding& insert(Name_binding&&);
+
+  template<typename F>
+  void for_each(F);
+
+  std::size_t size() const { return num + large.size(); }
+
+private:
+  using Storage = std::aligned_storage<sizeof(Name_binding), alignof(Name_binding)>::type;
+  using Table   = std::unordered_map<Name const*, Name_binding>;
+
+  Name_binding*       small()       { return reinterpret_cast<Name_binding*>(buf); }
+  Name_binding const* small() const { return reinterpret_cast<Name_binding const*>(buf); }
+
+  std::size_t num;               // The number of small bindings
+  Storage     buf[small_size];   // Storage for small bindings
+  Table       large;             // The bindings of large maps
+};
+
+
+inline Name_binding const*
+Name_map::find(Name const& n) const
+{
+  for (Name_binding const* p = small(); p != small() + num; ++p) {
+    if (p->name == &n)
+      return p;
+  }
+  if (!large.empty()) {
+    auto iter = large.find(&n);
+    if (iter != large.end())
+      return &iter->second;
+  }
+  return nullptr;
+}
+
 
-// Maps names to overload sets.
-using Name_map = std::unordered_map<Name const*, Overload_set, Name_hash, Name_eq>;
+inline Name_binding*
+Name_map::find(Name const& n)
+{
+  Name_map const* self = this;
+  return const_cast<Name_binding*>(self->find(n));
+}
+
+
+// Call f for each binding in the map.
+template<typename F>
+inline void
+Name_map::for_each(F f)
+{
+  for (Name_binding* p = small(); p != small() + num; ++p)
+    f(*p);
+  for (auto& x : large)
+    f(x.second);
+}
 
 
 // A scope defines a maximal lexical region of text where an
@@ -26,30 +132,48 @@ using Name_map = std::unordered_map<Name const*, Overload_set, Name_hash, Name_e
 //
 // The scope class also defines a region of text where a dependent
 // expression may occur.
+//
+// A scope is visible when it is the current scope or one of its
+// enclosing scopes. Visibility is maintained by the context as
+// scopes are entered and left (see Context::set_scope).
+//
+// The bindings of a scope are normally linked into the chains of
+// their names. Scopes created by worker contexts are not linked, so
+// that they do not modify names shared with other threads (see
+// find_binding(Scope&, Name const&)).
 struct Scope
 {
-  using Binding = Name_map::value_type;
+  using Binding = Name_binding;
+
+  // Construct the outermost scope.
+  Scope()
+    : parent(nullptr), decl(nullptr), depth(0), visible(false), linked(true)
+  { }
 
   // Construct a new scope with the given parent. This is
   // used to create scopes that are not affiliated with a
   // declaration.
   Scope(Scope& p)
-    : parent(&p), decl(nullptr)
+    : parent(&p), decl(nullptr), depth(p.depth + 1), visible(false), linked(true)
   { }
 
   // Construct a scope for the given declaration, but with
   // no enclosing scope. 
   Scope(Decl& d)
-    : parent(nullptr), decl(&d)
+    : parent(nullptr), decl(&d), depth(0), visible(false), linked(true)
   { }
 
   // Construct a scope having the given parent and affiliated with
   // the declaration.
   Scope(Scope& p, Decl& d)
-    : parent(&p), decl(&d)
+    : parent(&p), decl(&d), depth(p.depth + 1), visible(false), linked(true)
   { }
 
-  virtual ~Scope() { }
+  virtual ~Scope();
+
+  // Non-copyable
+  Scope(Scope const&) = delete;
+  Scope& operator=(Scope const&) = delete;
 
   // Returns the enclosing scope, if any. Only the global
   // namespace does not have an enclosing scope.
@@ -65,7 +189,7 @@ struct Scope
   // Create a name binding for the given declaration. Behavior
   // is undefined if a name binding already exists.
   //
-  // TODO: Assert that `n` is a form of simple id.
+  // TODO: Assert that `n` is a unique name.
   Binding& bind(Decl& d);
   Binding& bind(Name const&, Decl&);
 
@@ -75,34 +199,23 @@ struct Scope
   Overload_set*       lookup(Name const& n);
 
   // Returns 1 if the name is bound and 0 otherwise.
-  std::size_t count(Name const& n) const { return names.count(&n); }
+  std::size_t count(Name const& n) const { return names.find(n) != nullptr; }
 
   Scope*   parent;
   Decl*    decl;
+  int      depth;   // The number of enclosing scopes
+  bool     visible; // True if the scope is visible
+  bool     linked;  // True if bindings are linked to their names
   Name_map names;
 };
 
 
-// Bind n to `d` in this scope.
-//
-// Note that the addition of declarations to an overload set
-// must be handled by semantic rules.
-inline Scope::Binding&
-Scope::bind(Name const& n, Decl& d)
-{
-  lingo_assert(count(n) == 0);
-  auto ins = names.insert({&n, {d}});
-  return *ins.first;
-}
-
-
 // Returns the binding for n, if any.
 inline Overload_set const*
 Scope::lookup(Name const& n) const
 {
-  auto iter = names.find(&n);
-  if (iter != names.end())
-    return &iter->second;
+  if (Name_binding const* b = names.find(n))
+    return &b->decls;
   else
     return nullptr;
 }
@@ -111,14 +224,17 @@ Scope::lookup(Name const& n) const
 inline Overload_set*
 Scope::lookup(Name const& n)
 {
-  auto iter = names.find(&n);
-  if (iter != names.end())
-    return &iter->second;
+  if (Name_binding* b = names.find(n))
+    return &b->decls;
   else
     return nullptr;
 }
 
 
+Overload_set* find_binding(Name const&);
+Overload_set* find_binding(Scope&, Name const&);
+
+
 } // namespace banjo
 
 
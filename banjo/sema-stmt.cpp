@@ -95,10 +95,9 @@ Parser::on_expression_statement(Expr& d)
 
 
 Stmt&
-Parser::on_unparsed_statement(Token_seq&& toks)
+Parser::on_unparsed_statement(Token_range toks)
 {
-  // FIXME: Use the builder.
-  return *new Unparsed_stmt(std::move(toks));
+  return cxt.make<Unparsed_stmt>(toks);
 }
 
 
@@ -157,10 +157,9 @@ Parser::on_pack_type(Type& t)
 
 
 Type&
-Parser::on_unparsed_type(Token_seq&& toks)
+Parser::on_unparsed_type(Token_range toks)
 {
-  // FIXME: Use a factory method.
-  return *new Unparsed_type(std::move(toks));
+  return cxt.make<Unparsed_type>(toks);
 }
 
 
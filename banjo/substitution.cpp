@@ -263,7 +263,7 @@ subst_conv(Context& cxt, Boolean_conv& e, Substitution& sub)
 {
   Expr& e1 = substitute(cxt, e.source(), sub);
   Type& t1 = substitute(cxt, e.destination(), sub);
-  return *new Boolean_conv(t1, e1);
+  return cxt.make<Boolean_conv>(t1, e1);
 }
 
 
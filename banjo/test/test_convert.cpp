@@ -84,42 +84,42 @@ test_standard_conversions(Context& cxt)
 
   // bool& ~> bool
   Reference_expr e1 = build.make_reference(v1);
-  Expr& c1 = standard_conversion(e1, b);
+  Expr& c1 = standard_conversion(cxt, e1, b);
   std::cout << c1 << '\n';
   Conversion_seq s1 = get_conversion_sequence(c1);
   assert(s1.kind() == std_conv_seq);
 
   // no conversion
   Boolean_expr e2 = build.get_true();
-  Expr& c2 = standard_conversion(e2, b);
+  Expr& c2 = standard_conversion(cxt, e2, b);
   std::cout << c2 << '\n';
   Conversion_seq s2 = get_conversion_sequence(c1);
   assert(s2.kind() == std_conv_seq);
 
   // bool-to-int
-  Expr& c3 = standard_conversion(e2, z);
+  Expr& c3 = standard_conversion(cxt, e2, z);
   std::cout << c3 << '\n';
 
   // int-to-bool
   Integer_expr e3 = build.get_int(0);
-  Expr& c4 = standard_conversion(e3, b);
+  Expr& c4 = standard_conversion(cxt, e3, b);
   std::cout << c4 << '\n';
 
   // bool& ~> int
-  Expr& c5 = standard_conversion(e1, z);
+  Expr& c5 = standard_conversion(cxt, e1, z);
   std::cout << c5 << '\n';
 
   // int ~> int const
-  Expr& c6 = standard_conversion(e3, cz);
+  Expr& c6 = standard_conversion(cxt, e3, cz);
   std::cout << c6 << '\n';
 
   // bool& ~> int const
-  Expr& c7 = standard_conversion(e1, cz);
+  Expr& c7 = standard_conversion(cxt, e1, cz);
   std::cout << c7 << '\n';
 
   // int const -> int
   Expr& e4 = build.get_integer(cz, 1);
-  Expr& c8 = standard_conversion(e4, z);
+  Expr& c8 = standard_conversion(cxt, e4, z);
   std::cout << c8 << '\n';
 }
 
@@ -139,10 +139,10 @@ test_arithmetic_conversions(Context& cxt)
   Expr& z32 = build.get_integer(i32, 1);
   Expr& n32 = build.get_integer(u32, 1);
 
-  Expr_pair p1 = arithmetic_conversion(z16, z32);
+  Expr_pair p1 = arithmetic_conversion(cxt, z16, z32);
   std::cout << p1.first << " ## " << p1.second << '\n';
 
-  Expr_pair p2 = arithmetic_conversion(n32, z32);
+  Expr_pair p2 = arithmetic_conversion(cxt, n32, z32);
   std::cout << p2.first << " ## " << p2.second << '\n';
 
   // TODO: Fully exhaust all of the different testing rules.
@@ -51,16 +51,16 @@ main(int argc, char* argv[])
   }
 
   File input(argv[1]);
-  Character_stream cs(input);
-  Token_stream ts;
-  Lexer lex(cxt, cs, ts);
-  Parser parse(cxt, ts);
+  Lexer lex(cxt, input, cxt.tokens());
 
   // Transform characters into tokens.
   lex();
   if (error_count())
     return 1;
 
+  banjo::Token_stream ts(cxt.tokens());
+  Parser parse(cxt, ts);
+
   // Parse the translation unit.
   parse();
   if (error_count())
@@ -115,7 +115,7 @@ void
 type_directive(Parser& p)
 {
   p.require("type");
-  Expr& e = p.expression();
+  Expr& e = p.required(p.expression());
   p.match(semicolon_tok);
   std::cout << e.type() << '\n';
 }
@@ -125,7 +125,7 @@ void
 evaluate_directive(Parser& p)
 {
   p.require("evaluate");
-  Expr& e = p.expression();
+  Expr& e = p.required(p.expression());
   p.match(semicolon_tok);
   std::cout << reduce(p.cxt, e) << '\n';
 }
@@ -248,7 +248,7 @@ void
 inspect_expression_directive(Parser& p)
 {
   p.require("expression");
-  Expr& e = p.expression();
+  Expr& e = p.required(p.expression());
   p.match(semicolon_tok);
   std::cout << debug(e) << '\n';
 }
@@ -0,0 +1,135 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/call.hpp>
+#include <banjo/overload.hpp>
+
+#include <cassert>
+#include <iostream>
+
+
+// Declare the function `n` with parameters of types t1 and t2.
+Function_decl&
+make_function(Builder& build, char const* n, Type& t1, Type& t2)
+{
+  Decl_list ps = {
+    &build.make_object_parm("x", t1),
+    &build.make_object_parm("y", t2)
+  };
+  Type& z = build.get_int_type();
+  return build.make_function_declaration(build.get_id(n), ps, z, build.get_int(0));
+}
+
+
+// Add f to the overload set and index it as a candidate.
+void
+declare(Overload_set& ovl, Function_decl& f)
+{
+  if (&ovl.front() != &f)
+    ovl.insert(f);
+  ovl.index_signature(f);
+}
+
+
+// Returns the function called by the call expression e.
+Decl const&
+called_function(Expr const& e)
+{
+  return cast<Function_expr>(cast<Call_expr>(e).function()).declaration();
+}
+
+
+// Given f(int, bool) and f(bool, bool), the call f(0, 0) selects
+// f(int, bool). Both candidates convert the second argument, but only
+// f(bool, bool) converts the first.
+void
+test_better(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+  Type& z = build.get_int_type();
+
+  Function_decl& f1 = make_function(build, "f", z, b);
+  Function_decl& f2 = make_function(build, "f", b, b);
+  Overload_set ovl(f1);
+  declare(ovl, f1);
+  declare(ovl, f2);
+
+  Expr_list args {&build.get_int(0), &build.get_int(0)};
+  Function_candidate c1 = probe_function_candidate(cxt, f1, args);
+  Function_candidate c2 = probe_function_candidate(cxt, f2, args);
+  assert(c1 && c2);
+  assert(compare(c1, c2) == better_conv);
+  assert(compare(c2, c1) == worse_conv);
+
+  Expr& e = resolve_function_call(cxt, ovl, args);
+  std::cout << e << '\n';
+  assert(&called_function(e) == &f1);
+}
+
+
+// Given k(int, bool) and k(bool, int), the call k(0, 0) is ambiguous.
+// Each candidate converts a different argument.
+void
+test_ambiguous(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+  Type& z = build.get_int_type();
+
+  Function_decl& k1 = make_function(build, "k", z, b);
+  Function_decl& k2 = make_function(build, "k", b, z);
+  Overload_set ovl(k1);
+  declare(ovl, k1);
+  declare(ovl, k2);
+
+  Expr_list args {&build.get_int(0), &build.get_int(0)};
+  Function_candidate c1 = probe_function_candidate(cxt, k1, args);
+  Function_candidate c2 = probe_function_candidate(cxt, k2, args);
+  assert(compare(c1, c2) == indistinct_conv);
+
+  bool ambiguous = false;
+  try {
+    resolve_function_call(cxt, ovl, args);
+  } catch (Type_error&) {
+    ambiguous = true;
+  }
+  assert(ambiguous);
+}
+
+
+// Given g(int, int) and g(bool, bool), the call g(0, 0) selects
+// g(int, int), and the call g(0, 0, 0) has no candidates.
+void
+test_arity(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+  Type& z = build.get_int_type();
+
+  Function_decl& g1 = make_function(build, "g", z, z);
+  Function_decl& g2 = make_function(build, "g", b, b);
+  Overload_set ovl(g1);
+  declare(ovl, g1);
+  declare(ovl, g2);
+
+  Expr_list args2 {&build.get_int(0), &build.get_int(0)};
+  Expr& e = resolve_function_call(cxt, ovl, args2);
+  assert(&called_function(e) == &g1);
+
+  Expr_list args3 {&build.get_int(0), &build.get_int(0), &build.get_int(0)};
+  assert(probe_candidates(cxt, ovl, args3).empty());
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  Context cxt;
+
+  test_better(cxt);
+  test_ambiguous(cxt);
+  test_arity(cxt);
+}
@@ -36,10 +36,7 @@ main(int argc, char* argv[])
   }
 
   File input(argv[1]);
-  Character_stream cs(input);
-  Token_stream ts;
-  Lexer lex(cxt, cs, ts);
-  Parser parse(cxt, ts);
+  Lexer lex(cxt, input, cxt.tokens());
 
   try {
     // Transform characters into tokens.
@@ -48,6 +45,8 @@ main(int argc, char* argv[])
       return -1;
 
     // Transform tokens into a syntax tree.
+    banjo::Token_stream ts(cxt.tokens());
+    Parser parse(cxt, ts);
     Term& unit = parse();
     if (error_count())
       return 1;
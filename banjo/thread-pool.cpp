@@ -0,0 +1,94 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "thread-pool.hpp"
+
+
+namespace banjo
+{
+
+// Start n worker threads. At least one thread is started.
+Thread_pool::Thread_pool(int n)
+  : pending(0), done(false)
+{
+  if (n < 1)
+    n = 1;
+  workers.reserve(n);
+  for (int i = 0; i < n; ++i)
+    workers.emplace_back([this]() { work(); });
+}
+
+
+// Wait for all submitted tasks to finish, then stop the workers.
+Thread_pool::~Thread_pool()
+{
+  {
+    std::unique_lock<std::mutex> g(lock);
+    idle.wait(g, [this]() { return pending == 0; });
+    done = true;
+  }
+  ready.notify_all();
+  for (std::thread& t : workers)
+    t.join();
+}
+
+
+void
+Thread_pool::submit(Task t)
+{
+  {
+    std::lock_guard<std::mutex> g(lock);
+    tasks.push_back(std::move(t));
+    ++pending;
+  }
+  ready.notify_one();
+}
+
+
+// Block until all submitted tasks have finished. If any task threw an
+// exception, the first is rethrown.
+void
+Thread_pool::wait()
+{
+  std::unique_lock<std::mutex> g(lock);
+  idle.wait(g, [this]() { return pending == 0; });
+  if (error) {
+    std::exception_ptr e = error;
+    error = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+
+// Run tasks until the pool is shut down.
+void
+Thread_pool::work()
+{
+  while (true) {
+    Task t;
+    {
+      std::unique_lock<std::mutex> g(lock);
+      ready.wait(g, [this]() { return done || !tasks.empty(); });
+      if (tasks.empty())
+        return;
+      t = std::move(tasks.front());
+      tasks.pop_front();
+    }
+
+    std::exception_ptr e;
+    try {
+      t();
+    } catch (...) {
+      e = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> g(lock);
+    if (e && !error)
+      error = e;
+    if (--pending == 0)
+      idle.notify_all();
+  }
+}
+
+
+} // namespace banjo
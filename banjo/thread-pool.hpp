@@ -0,0 +1,58 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_THREAD_POOL_HPP
+#define BANJO_THREAD_POOL_HPP
+
+// This module defines a simple pool of worker threads.
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace banjo
+{
+
+// A fixed set of worker threads that run submitted tasks in the order
+// in which they were submitted. Tasks may finish in any order.
+//
+// If a task throws an exception, the first such exception is rethrown
+// by wait(). Remaining tasks are still run.
+struct Thread_pool
+{
+  using Task = std::function<void()>;
+
+  explicit Thread_pool(int);
+  ~Thread_pool();
+
+  // Non-copyable
+  Thread_pool(Thread_pool const&) = delete;
+  Thread_pool& operator=(Thread_pool const&) = delete;
+
+  void submit(Task);
+  void wait();
+
+  int size() const { return workers.size(); }
+
+  void work();
+
+  std::vector<std::thread> workers;
+  std::deque<Task>         tasks;
+  std::mutex               lock;
+  std::condition_variable  ready;   // Signaled when a task is submitted
+  std::condition_variable  idle;    // Signaled when all tasks are done
+  std::size_t              pending; // Submitted but unfinished tasks
+  std::exception_ptr       error;   // The first exception thrown
+  bool                     done;    // True when the pool is shutting down
+};
+
+
+} // namespace banjo
+
+
+#endif
@@ -0,0 +1,353 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_TOKEN_BUFFER_HPP
+#define BANJO_TOKEN_BUFFER_HPP
+
+// This module defines the storage of tokens for a translation.
+//
+// All tokens of a translation are stored in a single contiguous,
+// append-only buffer. Each token is represented by a compact entry
+// (its symbol, kind, and position in its input). Unparsed terms refer
+// to ranges of that buffer, and token streams are cursors within those
+// ranges. A lingo Token is only created when the parser asks for one.
+
+#include "prelude.hpp"
+
+#include <lingo/file.hpp>
+#include <lingo/token.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace banjo
+{
+
+// A compact representation of a token. The location of the token is
+// the offset of its first character within its input.
+struct Token_entry
+{
+  Symbol const* sym;    // The token's symbol
+  std::uint32_t offset; // The offset of the token within its input
+  std::uint16_t input;  // The index of the input
+  std::int16_t  kind;   // The token kind
+};
+
+static_assert(sizeof(Token_entry) <= 16, "token entries must be compact");
+
+
+// An append-only sequence of tokens. Inputs are registered with the
+// buffer before their tokens are added.
+//
+// A mapped input is registered by its path and has no lingo file, so
+// the locations of its tokens record only their offsets. Diagnostics
+// use source_location() instead, which reads the file of a mapped
+// input the first time a diagnostic refers to it.
+//
+// The number of inputs, the size of each input, and the number of
+// tokens are limited by the sizes of the fields of a token entry.
+// Exceeding them is reported as a Limitation_error.
+//
+// The buffer also records, for each bracketing token, the index of the
+// matching bracket. This allows a bracketed group of tokens to be
+// skipped in constant time.
+struct Token_buffer
+{
+  using Index = std::uint32_t;
+
+  static constexpr Index npos = Index(-1);
+
+  static constexpr std::size_t max_inputs = std::size_t(std::uint16_t(-1)) + 1;
+  static constexpr std::size_t max_offset = Index(-1);
+
+  int add_input(File*);
+  int add_input(String const&);
+  void put(int, std::size_t, Symbol const&);
+  void append(Token_buffer&);
+  void reserve(std::size_t n) { entries.reserve(n); matches.reserve(n); }
+
+  void match(Index, Index);
+  Index matching(Index n) const { return matches[n]; }
+
+  Index size() const { return entries.size(); }
+  bool empty() const { return entries.empty(); }
+
+  Token_entry const& entry(Index n) const { return entries[n]; }
+  int kind(Index n) const { return entries[n].kind; }
+  Location location(Index n) const;
+  Location source_location(Index n) const;
+  Location source_location(int, Index) const;
+  Token token(Index n) const;
+
+  std::vector<Token_entry> entries;
+  std::vector<Index>       matches; // Matching brackets, or npos
+  std::vector<File*>       inputs;  // Input files, or null if mapped
+  std::vector<String>      paths;   // The paths of mapped inputs
+
+  // Files read for the diagnostics of mapped inputs, by input.
+  mutable std::unordered_map<int, std::unique_ptr<File>> files;
+  mutable std::mutex lock;
+};
+
+
+// Register the input file f, returning its index.
+inline int
+Token_buffer::add_input(File* f)
+{
+  if (inputs.size() == max_inputs)
+    throw Limitation_error("too many inputs");
+  inputs.push_back(f);
+  paths.emplace_back();
+  return inputs.size() - 1;
+}
+
+
+// Register the mapped input at the given path, returning its index.
+inline int
+Token_buffer::add_input(String const& path)
+{
+  if (inputs.size() == max_inputs)
+    throw Limitation_error("too many inputs");
+  inputs.push_back(nullptr);
+  paths.push_back(path);
+  return inputs.size() - 1;
+}
+
+
+// Add a token for the symbol at the given offset of an input. The lexer
+// rejects inputs larger than max_offset.
+inline void
+Token_buffer::put(int in, std::size_t off, Symbol const& sym)
+{
+  lingo_assert(0 <= in && std::size_t(in) < inputs.size());
+  lingo_assert(off <= max_offset);
+  if (entries.size() == npos)
+    throw Limitation_error("too many tokens");
+  entries.push_back(Token_entry{&sym, Index(off), std::uint16_t(in), std::int16_t(sym.token())});
+  matches.push_back(Index(npos));
+}
+
+
+// Record that the brackets at indexes m and n match.
+inline void
+Token_buffer::match(Index m, Index n)
+{
+  matches[m] = n;
+  matches[n] = m;
+}
+
+
+// Append the tokens of another buffer. The inputs of that buffer are
+// registered with this one, and the inputs and matching brackets of its
+// tokens are renumbered accordingly. Files read for diagnostics of the
+// other buffer are moved to this one.
+inline void
+Token_buffer::append(Token_buffer& b)
+{
+  if (inputs.size() + b.inputs.size() > max_inputs)
+    throw Limitation_error("too many inputs");
+  if (entries.size() + b.entries.size() >= npos)
+    throw Limitation_error("too many tokens");
+
+  std::size_t base = inputs.size();
+  inputs.insert(inputs.end(), b.inputs.begin(), b.inputs.end());
+  paths.insert(paths.end(), b.paths.begin(), b.paths.end());
+  for (auto& f : b.files)
+    files.emplace(base + f.first, std::move(f.second));
+  b.files.clear();
+
+  entries.reserve(entries.size() + b.entries.size());
+  for (Token_entry e : b.entries) {
+    e.input += base;
+    entries.push_back(e);
+  }
+
+  Index first = matches.size();
+  matches.reserve(matches.size() + b.matches.size());
+  for (Index m : b.matches)
+    matches.push_back(m == npos ? npos : first + m);
+}
+
+
+// Returns the location of the nth token. The location of a token in a
+// mapped input has no file.
+inline Location
+Token_buffer::location(Index n) const
+{
+  Token_entry const& e = entries[n];
+  return Location(inputs[e.input], e.offset);
+}
+
+
+// Returns the location of the nth token for a diagnostic.
+inline Location
+Token_buffer::source_location(Index n) const
+{
+  Token_entry const& e = entries[n];
+  return source_location(e.input, e.offset);
+}
+
+
+// Returns the location of the given offset in an input for a diagnostic.
+// If the input is mapped, its file is read the first time it is needed.
+// This may be called concurrently.
+inline Location
+Token_buffer::source_location(int in, Index off) const
+{
+  if (File* f = inputs[in])
+    return Location(f, off);
+  std::lock_guard<std::mutex> guard(lock);
+  std::unique_ptr<File>& f = files[in];
+  if (!f)
+    f.reset(new File(paths[in]));
+  return Location(f.get(), off);
+}
+
+
+// Returns the nth token.
+inline Token
+Token_buffer::token(Index n) const
+{
+  return Token(location(n), entries[n].sym);
+}
+
+
+// A range of tokens in a buffer.
+struct Token_range
+{
+  using Index = Token_buffer::Index;
+
+  Token_range()
+    : buf(nullptr), first(0), last(0)
+  { }
+
+  Token_range(Token_buffer const& b, Index f, Index l)
+    : buf(&b), first(f), last(l)
+  { }
+
+  Index size() const { return last - first; }
+  bool empty() const { return first == last; }
+
+  Token_buffer const& buffer() const { return *buf; }
+
+  Token_buffer const* buf;
+  Index               first;
+  Index               last;
+};
+
+
+// A cursor over a range of tokens in a buffer. Looking ahead and
+// repositioning the stream are constant time operations.
+struct Token_stream
+{
+  using Index = Token_buffer::Index;
+  using Position = Index;
+
+  Token_stream(Token_buffer const& b)
+    : buf(&b), pos(0), last(b.size())
+  { }
+
+  Token_stream(Token_range r)
+    : buf(r.buf), pos(r.first), last(r.last)
+  { }
+
+  bool eof() const { return pos == last; }
+
+  int kind() const;
+  int kind(int) const;
+  Token peek() const;
+  Token peek(int) const;
+  Token get();
+  Location location() const;
+
+  Position position() const { return pos; }
+  void reposition(Position p) { pos = p; }
+
+  Token_range range(Position f, Position l) const { return {*buf, f, l}; }
+
+  Position matching() const;
+
+  Token_buffer const* buf;
+  Index               pos;
+  Index               last;
+};
+
+
+// Returns the kind of the current token. At the end of input, this is
+// the kind of an invalid token.
+inline int
+Token_stream::kind() const
+{
+  return kind(0);
+}
+
+
+// Returns the kind of the nth token past the current token.
+inline int
+Token_stream::kind(int n) const
+{
+  if (pos + n < last)
+    return buf->kind(pos + n);
+  return Token().kind();
+}
+
+
+// Returns the current token, or an invalid token at the end of input.
+inline Token
+Token_stream::peek() const
+{
+  return peek(0);
+}
+
+
+// Returns the nth token past the current token, or an invalid token
+// if there is no such token.
+inline Token
+Token_stream::peek(int n) const
+{
+  if (pos + n < last)
+    return buf->token(pos + n);
+  return Token();
+}
+
+
+// Returns the current token and advances the stream.
+inline Token
+Token_stream::get()
+{
+  Token tok = peek();
+  if (pos != last)
+    ++pos;
+  return tok;
+}
+
+
+// Returns the position of the bracket matching the current token, or
+// npos if the current token is not a matched bracket.
+inline Token_stream::Position
+Token_stream::matching() const
+{
+  if (pos != last)
+    return buf->matching(pos);
+  return Token_buffer::npos;
+}
+
+
+// Returns the location of the current token for a diagnostic.
+inline Location
+Token_stream::location() const
+{
+  if (pos != last)
+    return buf->source_location(pos);
+  return Location();
+}
+
+
+} // namespace banjo
+
+
+#endif
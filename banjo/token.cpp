@@ -3,6 +3,9 @@
 
 #include "token.hpp"
 
+#include <cstdint>
+#include <cstring>
+
 namespace banjo
 {
 
@@ -45,12 +48,194 @@ init_token(Symbol_table& syms, Token_kind k, char const* s)
 
 
 void
-init_token_class(Symbol_table& syms, Token_kind k, char const* s)
+init_token_class(Token_kind k, char const* s)
 {
   spelling.emplace(k, s);
 }
 
 
+// -------------------------------------------------------------------------- //
+// Keywords
+//
+// Keywords are recognized by a perfect hash over their spellings. The
+// hash table is generated at compile time by searching for a seed for
+// which no two keywords share a slot. Recognizing a keyword requires
+// hashing the word and comparing it to at most one keyword.
+
+namespace
+{
+
+struct Keyword
+{
+  char const* spelling;
+  Token_kind  kind;
+};
+
+
+constexpr Keyword keywords[] {
+  {"abstract", abstract_tok},
+  {"axiom", axiom_tok},
+  {"auto", auto_tok},
+  {"bool", bool_tok},
+  {"break", break_tok},
+  {"byte", byte_tok},
+  {"char", char_tok},
+  {"case", case_tok},
+  {"class", class_tok},
+  {"concept", concept_tok},
+  {"const", const_tok},
+  {"consume", consume_tok},
+  {"continue", continue_tok},
+  {"decltype", decltype_tok},
+  {"def", def_tok},
+  {"default", default_tok},
+  {"delete", delete_tok},
+  {"do", do_tok},
+  {"double", double_tok},
+  {"dynamic", dynamic_tok},
+  {"else", else_tok},
+  {"enum", enum_tok},
+  {"explicit", explicit_tok},
+  {"export", export_tok},
+  {"false", false_tok},
+  {"float", float_tok},
+  {"for", for_tok},
+  {"forward", forward_tok},
+  {"if", if_tok},
+  {"implicit", implicit_tok},
+  {"import", import_tok},
+  {"in", in_tok},
+  {"inline", inline_tok},
+  {"int", int_tok},
+  {"mutable", mutable_tok},
+  {"namespace", namespace_tok},
+  {"operator", operator_tok},
+  {"out", out_tok},
+  {"public", public_tok},
+  {"private", private_tok},
+  {"protected", protected_tok},
+  {"requires", requires_tok},
+  {"return", return_tok},
+  {"static", static_tok},
+  {"struct", struct_tok},
+  {"super", super_tok},
+  {"switch", switch_tok},
+  {"template", template_tok},
+  {"true", true_tok},
+  {"type", type_tok},
+  {"typename", typename_tok},
+  {"uint", uint_tok},
+  {"union", union_tok},
+  {"using", using_tok},
+  {"virtual", virtual_tok},
+  {"var", var_tok},
+  {"void", void_tok},
+  {"volatile", volatile_tok},
+  {"while", while_tok},
+};
+
+
+constexpr std::size_t num_keywords = sizeof(keywords) / sizeof(Keyword);
+
+static_assert(num_keywords == last_keyword_tok - first_keyword_tok - 1,
+              "missing keyword spellings");
+
+
+constexpr std::size_t
+length(char const* s)
+{
+  std::size_t n = 0;
+  while (s[n])
+    ++n;
+  return n;
+}
+
+
+constexpr std::uint32_t
+keyword_hash(std::uint32_t seed, char const* s, std::size_t n)
+{
+  std::uint32_t h = seed ^ n;
+  for (std::size_t i = 0; i < n; ++i)
+    h = (h ^ static_cast<unsigned char>(s[i])) * 0x01000193u;
+  return h ^ (h >> 16);
+}
+
+
+// A perfect hash table of keywords. Each slot holds one plus the
+// index of a keyword, or 0 if the slot is empty.
+struct Keyword_table
+{
+  static constexpr std::size_t size = 512;
+  static constexpr std::size_t mask = size - 1;
+
+  std::uint32_t seed;
+  std::size_t   min_length;
+  std::size_t   max_length;
+  std::uint8_t  lengths[num_keywords];
+  std::uint8_t  slots[size];
+};
+
+
+// Find the first seed for which the keyword hash has no collisions.
+constexpr Keyword_table
+make_keyword_table()
+{
+  Keyword_table t {};
+  t.min_length = std::size_t(-1);
+  for (std::size_t i = 0; i < num_keywords; ++i) {
+    std::size_t n = length(keywords[i].spelling);
+    t.lengths[i] = n;
+    if (n < t.min_length)
+      t.min_length = n;
+    if (n > t.max_length)
+      t.max_length = n;
+  }
+
+  for (t.seed = 1; t.seed != 0; ++t.seed) {
+    for (std::size_t j = 0; j < Keyword_table::size; ++j)
+      t.slots[j] = 0;
+    std::size_t i = 0;
+    for (; i < num_keywords; ++i) {
+      char const* s = keywords[i].spelling;
+      std::size_t k = keyword_hash(t.seed, s, t.lengths[i]) & Keyword_table::mask;
+      if (t.slots[k])
+        break;
+      t.slots[k] = i + 1;
+    }
+    if (i == num_keywords)
+      return t;
+  }
+  return t;
+}
+
+
+constexpr Keyword_table keyword_table = make_keyword_table();
+
+static_assert(keyword_table.seed != 0, "no perfect hash for keywords");
+
+
+} // namespace
+
+
+// Returns the kind of keyword spelled by the characters in [first, last),
+// or identifier_tok if those characters do not spell a keyword.
+Token_kind
+lookup_keyword(char const* first, char const* last)
+{
+  Keyword_table const& t = keyword_table;
+  std::size_t n = last - first;
+  if (n < t.min_length || n > t.max_length)
+    return identifier_tok;
+  std::size_t k = t.slots[keyword_hash(t.seed, first, n) & Keyword_table::mask];
+  if (!k)
+    return identifier_tok;
+  Keyword const& kw = keywords[k - 1];
+  if (t.lengths[k - 1] != n || std::memcmp(kw.spelling, first, n) != 0)
+    return identifier_tok;
+  return kw.kind;
+}
+
+
 // Initialize the token set used by the language.
 void
 init_tokens(Symbol_table& syms)
@@ -96,68 +281,11 @@ init_tokens(Symbol_table& syms)
   init_token(syms, dollar_tok, "$");
 
   // Keywords
-  init_token(syms, abstract_tok, "abstract");
-  init_token(syms, axiom_tok, "axiom");
-  init_token(syms, auto_tok, "auto");
-  init_token(syms, bool_tok, "bool");
-  init_token(syms, break_tok, "break");
-  init_token(syms, byte_tok, "byte");
-  init_token(syms, char_tok, "char");
-  init_token(syms, case_tok, "case");
-  init_token(syms, class_tok, "class");
-  init_token(syms, concept_tok, "concept");
-  init_token(syms, const_tok, "const");
-  init_token(syms, consume_tok, "consume");
-  init_token(syms, continue_tok, "continue");
-  init_token(syms, decltype_tok, "decltype");
-  init_token(syms, def_tok, "def");
-  init_token(syms, default_tok, "default");
-  init_token(syms, delete_tok, "delete");
-  init_token(syms, do_tok, "do");
-  init_token(syms, double_tok, "double");
-  init_token(syms, dynamic_tok, "dynamic");
-  init_token(syms, else_tok, "else");
-  init_token(syms, enum_tok, "enum");
-  init_token(syms, explicit_tok, "explicit");
-  init_token(syms, export_tok, "export");
-  init_token(syms, false_tok, "false");
-  init_token(syms, float_tok, "float");
-  init_token(syms, for_tok, "for");
-  init_token(syms, forward_tok, "forward");
-  init_token(syms, if_tok, "if");
-  init_token(syms, implicit_tok, "implicit");
-  init_token(syms, import_tok, "import");
-  init_token(syms, in_tok, "in");
-  init_token(syms, inline_tok, "inline");
-  init_token(syms, int_tok, "int");
-  init_token(syms, mutable_tok, "mutable");
-  init_token(syms, namespace_tok, "namespace");
-  init_token(syms, operator_tok, "operator");
-  init_token(syms, out_tok, "out");
-  init_token(syms, public_tok, "public");
-  init_token(syms, private_tok, "private");
-  init_token(syms, protected_tok, "protected");
-  init_token(syms, requires_tok, "requires");
-  init_token(syms, return_tok, "return");
-  init_token(syms, static_tok, "static");
-  init_token(syms, struct_tok, "struct");
-  init_token(syms, super_tok, "super");
-  init_token(syms, switch_tok, "switch");
-  init_token(syms, template_tok, "template");
-  init_token(syms, true_tok, "true");
-  init_token(syms, type_tok, "type");
-  init_token(syms, typename_tok, "typename");
-  init_token(syms, uint_tok, "uint");
-  init_token(syms, union_tok, "union");
-  init_token(syms, using_tok, "using");
-  init_token(syms, virtual_tok, "virtual");
-  init_token(syms, var_tok, "var");
-  init_token(syms, void_tok, "void");
-  init_token(syms, volatile_tok, "volatile");
-  init_token(syms, while_tok, "while");
-
-  init_token_class(syms, identifier_tok, "<identifier>");
-  init_token_class(syms, integer_tok, "<integer>");
+  for (Keyword const& k : keywords)
+    init_token(syms, k.kind, k.spelling);
+
+  init_token_class(identifier_tok, "<identifier>");
+  init_token_class(integer_tok, "<integer>");
 }
 
 
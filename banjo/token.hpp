@@ -140,8 +140,40 @@ is_word(Token_kind k)
   return k == identifier_tok || is_keyword(k);
 }
 
+// Returns true if k is an opening brace. Note that "braces" is meant to
+// imply any kind of bracketing characters.
+inline bool
+is_open_brace(Token_kind k)
+{
+  return k == lparen_tok || k == lbrace_tok || k == lbracket_tok;
+}
+
+
+// Returns true if k is a closing brace.
+inline bool
+is_close_brace(Token_kind k)
+{
+  return k == rparen_tok || k == rbrace_tok || k == rbracket_tok;
+}
+
+
+// Returns the closing brace that matches the opening brace k.
+inline Token_kind
+get_closing_brace(Token_kind k)
+{
+  switch (k) {
+    case lparen_tok: return rparen_tok;
+    case lbrace_tok: return rbrace_tok;
+    case lbracket_tok: return rbracket_tok;
+    default: lingo_unreachable();
+  }
+}
+
+
 char const* get_spelling(Token_kind);
 
+Token_kind lookup_keyword(char const*, char const*);
+
 void init_tokens(Symbol_table&);
 
 
@@ -5,6 +5,7 @@
 #include "ast.hpp"
 #include "context.hpp"
 #include "lookup.hpp"
+#include "parser.hpp"
 #include "printer.hpp"
 
 #include <iostream>
@@ -25,6 +26,9 @@ make_type(Context& cxt, Simple_id& id)
     throw Type_error("not a type");
   }
   Type_decl& decl = cast<Type_decl>(d);
+
+  // The type may be declared after the declaration being elaborated.
+  require_declaration(cxt, decl);
   return cxt.get_type(decl);
 }
 
@@ -49,12 +53,7 @@ make_type(Context& cxt, Name& n)
 Type&
 make_qualified_type(Context& cxt, Type& t, Qualifier_set q)
 {
-  if (Qualified_type* qt = as<Qualified_type>(&t)) {
-    qt->qual |= q;
-    return *qt;
-  } else {
-    return cxt.get_qualified_type(t, q);
-  }
+  return cxt.get_qualified_type(t, q);
 }
 
 